@@ -0,0 +1,147 @@
+#include "activity_map.h"
+#include "can_id_index.h"
+#include "frame_format.h"
+
+#include <QColor>
+#include <QPainter>
+#include <QPaintEvent>
+#include <algorithm>
+
+namespace {
+const QColor kIdleColor(200, 40, 40);
+const QColor kActiveColor(40, 200, 60);
+
+QColor blend(const QColor &from, const QColor &to, double amount)
+{
+    return QColor::fromRgbF(from.redF() + (to.redF() - from.redF()) * amount,
+                            from.greenF() + (to.greenF() - from.greenF()) * amount,
+                            from.blueF() + (to.blueF() - from.blueF()) * amount);
+}
+}
+
+ActivityMap::ActivityMap(QWidget *parent)
+    : QWidget(parent)
+    , repaintTimer(new QTimer(this))
+{
+    clock.start();
+    repaintTimer->setTimerType(Qt::PreciseTimer);
+    repaintTimer->setInterval(kRepaintMs);
+    connect(repaintTimer, &QTimer::timeout, this, [this]() {
+        update();
+        // Keep painting until the last lit cell has faded out
+        if (clock.elapsed() - newestSeenMs > kDecayMs) {
+            repaintTimer->stop();
+        }
+    });
+    setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
+}
+
+void ActivityMap::clear()
+{
+    slotOfKey.clear();
+    labels.clear();
+    lastSeenMs.clear();
+    hidden.clear();
+    visibleCount = 0;
+    layoutChanged();
+}
+
+void ActivityMap::addKey(uint32_t key)
+{
+    if (!slotOfKey.try_emplace(key, static_cast<uint32_t>(labels.size())).second) {
+        return;
+    }
+    labels.push_back(formatCANID(CANIDIndex::idOf(key), CANIDIndex::flagsOf(key)));
+    lastSeenMs.push_back(-kDecayMs);
+    hidden.push_back(0);
+    ++visibleCount;
+    layoutChanged();
+}
+
+void ActivityMap::setKeyHidden(uint32_t key, bool hide)
+{
+    auto it = slotOfKey.find(key);
+    if (it == slotOfKey.end() || hidden[it->second] == hide) {
+        return;
+    }
+    hidden[it->second] = hide;
+    visibleCount += hide ? -1 : 1;
+    layoutChanged();
+}
+
+void ActivityMap::markSeen(uint32_t key)
+{
+    auto it = slotOfKey.find(key);
+    if (it == slotOfKey.end()) {
+        return;
+    }
+    newestSeenMs = clock.elapsed();
+    lastSeenMs[it->second] = newestSeenMs;
+    if (!repaintTimer->isActive()) {
+        repaintTimer->start();
+    }
+}
+
+int ActivityMap::columnsFor(int width) const
+{
+    return std::max(1, (width - kSpacing) / (kCellWidth + kSpacing));
+}
+
+int ActivityMap::heightForWidth(int width) const
+{
+    int rows = (visibleCount + columnsFor(width) - 1) / columnsFor(width);
+    return kSpacing + rows * (kCellHeight + kSpacing);
+}
+
+QSize ActivityMap::sizeHint() const
+{
+    int width = parentWidget() ? parentWidget()->width() : 6 * (kCellWidth + kSpacing) + kSpacing;
+    return QSize(width, heightForWidth(width));
+}
+
+void ActivityMap::layoutChanged()
+{
+    // The scroll area around the map follows its minimum height
+    setMinimumHeight(heightForWidth(width()));
+    updateGeometry();
+    update();
+}
+
+void ActivityMap::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    setMinimumHeight(heightForWidth(width()));
+}
+
+void ActivityMap::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    QFont font = painter.font();
+    font.setBold(true);
+    painter.setFont(font);
+
+    qint64 now = clock.elapsed();
+    int columns = columnsFor(width());
+    int index = 0;
+    for (size_t slot = 0; slot < labels.size(); ++slot) {
+        if (hidden[slot]) {
+            continue;
+        }
+        QRect cell(kSpacing + (index % columns) * (kCellWidth + kSpacing),
+                   kSpacing + (index / columns) * (kCellHeight + kSpacing), kCellWidth, kCellHeight);
+        ++index;
+        if (!event->rect().intersects(cell)) {
+            continue;
+        }
+
+        // Full green when just seen, back to red after kDecayMs
+        double heat = 1.0 - static_cast<double>(now - lastSeenMs[slot]) / kDecayMs;
+        painter.setBrush(blend(kIdleColor, kActiveColor, std::clamp(heat, 0.0, 1.0)));
+        painter.setPen(Qt::NoPen);
+        painter.drawRoundedRect(cell, kCellHeight / 2.0, kCellHeight / 2.0);
+        painter.setPen(Qt::white);
+        painter.drawText(cell, Qt::AlignCenter, labels[slot]);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef ACTIVITY_MAP_H
+#define ACTIVITY_MAP_H
+#pragma once
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Grid of every CAN ID (CANIDIndex keys, in order of first appearance) that
+// lights up when the ID is seen and fades back over kDecayMs. Seeing an ID
+// only stores the time in a per-ID array; the whole grid is painted at most
+// once per kRepaintMs, and only while some cell is still fading, so the cost
+// does not depend on the frame rate or the number of IDs.
+class ActivityMap : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kDecayMs = 500;
+    static constexpr int kRepaintMs = 16;
+
+    explicit ActivityMap(QWidget *parent = nullptr);
+
+    void clear();
+    void addKey(uint32_t key);
+    // Hidden cells leave no gap in the grid
+    void setKeyHidden(uint32_t key, bool hidden);
+
+    void markSeen(uint32_t key);
+
+    bool hasHeightForWidth() const override { return true; }
+    int heightForWidth(int width) const override;
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    static constexpr int kCellWidth = 64;
+    static constexpr int kCellHeight = 32;
+    static constexpr int kSpacing = 6;
+
+    void layoutChanged();
+    int columnsFor(int width) const;
+
+    std::unordered_map<uint32_t, uint32_t> slotOfKey;
+    std::vector<QString> labels;
+    std::vector<qint64> lastSeenMs;  // per slot, clock.elapsed() when last seen
+    std::vector<uint8_t> hidden;
+    int visibleCount = 0;
+
+    QElapsedTimer clock;
+    qint64 newestSeenMs = -kDecayMs;
+    QTimer *repaintTimer;
+};
+
+#endif // ACTIVITY_MAP_H
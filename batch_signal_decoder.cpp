@@ -0,0 +1,225 @@
+#include "batch_signal_decoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BATCH_DECODE_X86 1
+#include <immintrin.h>
+#else
+#define BATCH_DECODE_X86 0
+#endif
+
+namespace {
+
+// Rows per task handed to a decode thread
+constexpr size_t kRowsPerTask = 64 * 1024;
+
+// Raw values up to this wide convert to double exactly with the
+// magic-number trick the AVX2 kernel uses in place of a 64-bit convert
+constexpr unsigned kMaxVectorBits = 51;
+
+template <typename T>
+void decodeWordsScalar(const uint8_t *payloads, const uint32_t *rows, size_t count, const SignalPlan &plan, T *values)
+{
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t word;
+        std::memcpy(&word, payloads + static_cast<size_t>(rows[i]) * CANFrameStore::kPayloadStride, sizeof(word));
+        values[i] = static_cast<T>(static_cast<double>(plan.fromWord(word)) * plan.factor + plan.offset);
+    }
+}
+
+#if BATCH_DECODE_X86
+
+// Four rows per iteration: gather their first payload words, swap bytes for
+// Motorola signals, shift and mask, sign extend with (x ^ s) - s, then turn
+// the integers into doubles by adding them to the mantissa of 1.5 * 2^52
+template <typename T>
+__attribute__((target("avx2")))
+void decodeWordsAVX2(const uint8_t *payloads, const uint32_t *rows, size_t count, const SignalPlan &plan, T *values)
+{
+    const __m256i byteSwap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                              7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m128i shift = _mm_cvtsi32_si128(plan.wordShift);
+    const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(plan.mask));
+    const __m256i signBit = _mm256_set1_epi64x(static_cast<long long>(plan.signBit));
+    const __m256i magic = _mm256_castpd_si256(_mm256_set1_pd(6755399441055744.0));  // 1.5 * 2^52
+    const __m256d magicDouble = _mm256_set1_pd(6755399441055744.0);
+    const __m256d factor = _mm256_set1_pd(plan.factor);
+    const __m256d offset = _mm256_set1_pd(plan.offset);
+    const long long *words = reinterpret_cast<const long long *>(payloads);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows + i));
+        __m256i word = _mm256_i32gather_epi64(words, index, 8);
+        if (plan.bigEndian) {
+            word = _mm256_shuffle_epi8(word, byteSwap);
+        }
+        __m256i bits = _mm256_and_si256(_mm256_srl_epi64(word, shift), mask);
+        bits = _mm256_sub_epi64(_mm256_xor_si256(bits, signBit), signBit);
+        __m256d raw = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(bits, magic)), magicDouble);
+        __m256d physical = _mm256_add_pd(_mm256_mul_pd(raw, factor), offset);
+        if constexpr (std::is_same_v<T, float>) {
+            _mm_storeu_ps(values + i, _mm256_cvtpd_ps(physical));
+        } else {
+            _mm256_storeu_pd(values + i, physical);
+        }
+    }
+    decodeWordsScalar(payloads, rows + i, count - i, plan, values + i);
+}
+
+#endif // BATCH_DECODE_X86
+
+template <typename T>
+using WordsFn = void (*)(const uint8_t *, const uint32_t *, size_t, const SignalPlan &, T *);
+
+struct BatchKernel {
+    WordsFn<double> decodeDouble;
+    WordsFn<float> decodeFloat;
+    const char *name;
+};
+
+BatchKernel selectKernel()
+{
+#if BATCH_DECODE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {decodeWordsAVX2<double>, decodeWordsAVX2<float>, "avx2"};
+    }
+#endif
+    return {decodeWordsScalar<double>, decodeWordsScalar<float>, "scalar"};
+}
+
+const BatchKernel &kernel()
+{
+    static const BatchKernel selected = selectKernel();
+    return selected;
+}
+
+template <typename T>
+WordsFn<T> wordsKernel()
+{
+    if constexpr (std::is_same_v<T, float>) {
+        return kernel().decodeFloat;
+    } else {
+        return kernel().decodeDouble;
+    }
+}
+
+// Raw value of plan in row, through the padded buffer when it needs more
+// than the payload column holds
+int64_t rawValue(const CANFrameStore &store, uint32_t row, const SignalPlan &plan)
+{
+    if (plan.fitsWord) {
+        uint64_t word;
+        std::memcpy(&word, store.payloads().data() + static_cast<size_t>(row) * CANFrameStore::kPayloadStride,
+                    sizeof(word));
+        return plan.fromWord(word);
+    }
+    uint8_t buffer[MessageDecoder::kBufferSize];
+    MessageDecoder::pad(store.payload(row), store.dlc(row), buffer);
+    return plan.raw(buffer);
+}
+
+template <typename T>
+void decodeColumn(const CANFrameStore &store, const uint32_t *rows, size_t count,
+                  const MessageDecoder &decoder, size_t signalIndex, T *values, uint8_t *present)
+{
+    const SignalPlan &plan = decoder.plan(signalIndex);
+    if (!plan.supported) {
+        std::fill(values, values + count, T(0));
+        std::fill(present, present + count, uint8_t(0));
+        return;
+    }
+
+    if (plan.fitsWord && decoder.signal(signalIndex).length <= kMaxVectorBits) {
+        wordsKernel<T>()(store.payloads().data(), rows, count, plan, values);
+    } else if (plan.fitsWord) {
+        decodeWordsScalar(store.payloads().data(), rows, count, plan, values);
+    } else {
+        // Long FD payloads live in the store's side table
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = static_cast<T>(static_cast<double>(rawValue(store, rows[i], plan)) * plan.factor + plan.offset);
+        }
+    }
+
+    const uint8_t *dlcs = store.dlcs().data();
+    const uint8_t *flags = store.flagColumn().data();
+    for (size_t i = 0; i < count; ++i) {
+        present[i] = dlcs[rows[i]] >= plan.minLength && !(flags[rows[i]] & FrameRemote);
+    }
+    if (plan.multiplexValue != SignalPlan::kNoMultiplex) {
+        int multiplexor = decoder.multiplexorIndex();
+        for (size_t i = 0; i < count; ++i) {
+            present[i] &= multiplexor >= 0
+                       && rawValue(store, rows[i], decoder.plan(multiplexor)) == plan.multiplexValue;
+        }
+    }
+}
+
+} // namespace
+
+const char *batchDecoderName()
+{
+    return kernel().name;
+}
+
+template <typename T>
+std::vector<SignalColumn<T>> decodeSignalColumns(const CANFrameStore &store,
+                                                 const std::vector<SignalColumnRequest> &requests,
+                                                 int threads)
+{
+    struct Task {
+        size_t request;
+        size_t firstRow;
+        size_t count;
+    };
+
+    std::vector<SignalColumn<T>> columns(requests.size());
+    std::vector<Task> tasks;
+    for (size_t r = 0; r < requests.size(); ++r) {
+        size_t rows = requests[r].count;
+        columns[r].values.resize(rows);
+        columns[r].present.resize(rows);
+        for (size_t first = 0; first < rows; first += kRowsPerTask) {
+            tasks.push_back({r, first, std::min(kRowsPerTask, rows - first)});
+        }
+    }
+
+    // Tasks are pulled one at a time, so threads spread across signals and
+    // IDs as well as across the rows of one big ID
+    std::atomic<size_t> nextTask{0};
+    auto work = [&]() {
+        for (size_t t = nextTask++; t < tasks.size(); t = nextTask++) {
+            const Task &task = tasks[t];
+            const SignalColumnRequest &request = requests[task.request];
+            SignalColumn<T> &column = columns[task.request];
+            decodeColumn(store, request.rows + task.firstRow, task.count, *request.decoder,
+                         request.signalIndex, column.values.data() + task.firstRow,
+                         column.present.data() + task.firstRow);
+        }
+    };
+
+    size_t workers = threads > 0 ? static_cast<size_t>(threads)
+                                 : std::max<size_t>(1, std::thread::hardware_concurrency());
+    workers = std::max<size_t>(1, std::min(workers, tasks.size()));
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t w = 1; w < workers; ++w) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    return columns;
+}
+
+template std::vector<SignalColumn<double>> decodeSignalColumns(const CANFrameStore &,
+                                                               const std::vector<SignalColumnRequest> &, int);
+template std::vector<SignalColumn<float>> decodeSignalColumns(const CANFrameStore &,
+                                                              const std::vector<SignalColumnRequest> &, int);
@@ -0,0 +1,49 @@
+#ifndef BATCH_SIGNAL_DECODER_H
+#define BATCH_SIGNAL_DECODER_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "frame_store.h"
+#include "signal_decoder.h"
+
+// Whole-column signal decoding: one signal of one message over a list of
+// rows (usually an ID's posting list from CANIDIndex) into a dense array.
+// Signals in the first 8 payload bytes are decoded straight from the
+// store's payload column; on AVX2 machines four frames at a time with a
+// 64-bit gather, byte swap, shift, mask and sign extension per lane.
+
+// Name of the kernel selected for this CPU ("avx2" or "scalar")
+const char *batchDecoderName();
+
+// One signal to decode over rows[0, count) of its message
+struct SignalColumnRequest {
+    const uint32_t *rows = nullptr;
+    size_t count = 0;
+    const MessageDecoder *decoder = nullptr;
+    size_t signalIndex = 0;
+};
+
+// present[i] is 1 when the signal exists in rows[i]: the payload is long
+// enough and, for multiplexed signals, the multiplexor selects it. values[i]
+// is only meaningful where present[i] is 1.
+template <typename T>
+struct SignalColumn {
+    std::vector<T> values;
+    std::vector<uint8_t> present;
+};
+
+// Decodes every request, splitting large ones into row ranges, on a pool
+// of threads. threads <= 0 uses every core. T is double or float.
+template <typename T>
+std::vector<SignalColumn<T>> decodeSignalColumns(const CANFrameStore &store,
+                                                 const std::vector<SignalColumnRequest> &requests,
+                                                 int threads = 0);
+
+extern template std::vector<SignalColumn<double>> decodeSignalColumns(const CANFrameStore &,
+                                                                      const std::vector<SignalColumnRequest> &, int);
+extern template std::vector<SignalColumn<float>> decodeSignalColumns(const CANFrameStore &,
+                                                                     const std::vector<SignalColumnRequest> &, int);
+
+#endif // BATCH_SIGNAL_DECODER_H
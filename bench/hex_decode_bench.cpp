@@ -0,0 +1,160 @@
+// Hex decoding of candump payloads: the dispatched decodeHexRun kernel
+// against a scalar table loop, and the whole-line CANLogParser against the
+// QRegularExpression/QString capture path the loader used before it. Run
+// from a Release build:
+//   cmake -DCANVIS_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release ..
+//   ./bench/hex_decode_bench
+
+#include "can_log_parser.h"
+#include "hex_decode.h"
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t kLines = 1000000;
+constexpr int kRepeats = 5;
+
+// Best of kRepeats, in milliseconds
+template <typename Fn>
+double bestMs(Fn &&fn)
+{
+    double best = 1e300;
+    for (int repeat = 0; repeat < kRepeats; ++repeat) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// One table lookup per digit, what hex_decode.cpp falls back to without SIMD
+size_t decodeHexScalar(const char *text, const char *end, uint8_t *out, size_t maxBytes)
+{
+    size_t bytes = 0;
+    while (bytes < maxBytes && end - text >= 2) {
+        uint8_t high = hexDigitValue(text[0]);
+        uint8_t low = hexDigitValue(text[1]);
+        if ((high | low) == 0xFF) {
+            break;
+        }
+        out[bytes++] = static_cast<uint8_t>(high << 4 | low);
+        text += 2;
+    }
+    return bytes;
+}
+
+struct Span {
+    const char *begin;
+    const char *end;
+};
+}
+
+int main()
+{
+    // One in four frames is a 64-byte CAN FD frame, the rest classic 8-byte
+    // frames with standard or extended IDs
+    static constexpr char kHex[] = "0123456789ABCDEF";
+    std::mt19937 random(1);
+    std::string text;
+    std::vector<Span> lines;
+    std::vector<size_t> payloadOffsets;
+    std::vector<size_t> lineOffsets;
+    for (size_t i = 0; i < kLines; ++i) {
+        lineOffsets.push_back(text.size());
+        text += "(1697550000." + std::to_string(100000 + i % 900000) + ") can0 ";
+        bool fd = i % 4 == 0;
+        bool extended = i % 3 == 0;
+        for (int digit = 0; digit < (extended ? 8 : 3); ++digit) {
+            text += kHex[random() % (extended && digit == 0 ? 2 : (digit == 0 ? 8 : 16))];
+        }
+        text += fd ? "##1" : "#";
+        payloadOffsets.push_back(text.size());
+        for (int byte = 0; byte < (fd ? 64 : 8); ++byte) {
+            text += kHex[random() % 16];
+            text += kHex[random() % 16];
+        }
+        text += '\n';
+    }
+    lineOffsets.push_back(text.size());
+    for (size_t i = 0; i < kLines; ++i) {
+        lines.push_back({text.data() + lineOffsets[i], text.data() + lineOffsets[i + 1] - 1});
+    }
+
+    std::vector<uint8_t> out(64);
+    uint64_t checksum = 0;
+    auto payloadsWith = [&](size_t (*decode)(const char *, const char *, uint8_t *, size_t)) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kLines; ++i) {
+            size_t bytes = decode(text.data() + payloadOffsets[i], lines[i].end, out.data(), 64);
+            sum += bytes + out[bytes - 1];
+        }
+        return sum;
+    };
+    uint64_t scalarSum = 0;
+    uint64_t kernelSum = 0;
+    double scalarMs = bestMs([&]() { scalarSum = payloadsWith(decodeHexScalar); });
+    double kernelMs = bestMs([&]() { kernelSum = payloadsWith(decodeHexRun); });
+
+    size_t parsed = 0;
+    double parserMs = bestMs([&]() {
+        parsed = 0;
+        CANFrame frame;
+        for (const Span &line : lines) {
+            parsed += CANLogParser::parseLine(line.begin, line.end, frame);
+            checksum += frame.id + frame.data[0];
+        }
+    });
+
+    // The loader before CANLogParser: a regex over each line as a QString.
+    // The captured ID and payload are converted here so both paths end with
+    // the same binary frame.
+    QStringList qlines;
+    qlines.reserve(static_cast<qsizetype>(kLines));
+    for (const Span &line : lines) {
+        qlines.append(QString::fromLatin1(line.begin, line.end - line.begin));
+    }
+    QRegularExpression logRegex(R"(\((.*?)\)\s+(.*?)\s+(.*?)#(.*))");
+    size_t qparsed = 0;
+    double qstringMs = bestMs([&]() {
+        qparsed = 0;
+        for (const QString &line : qlines) {
+            QRegularExpressionMatch match = logRegex.match(line);
+            if (!match.hasMatch()) {
+                continue;
+            }
+            bool ok = false;
+            uint32_t id = match.captured(3).toUInt(&ok, 16);
+            QString data = match.captured(4);
+            if (data.startsWith('#')) {
+                data = data.mid(2);
+            }
+            QByteArray payload = QByteArray::fromHex(data.toLatin1());
+            qparsed += ok;
+            checksum += id + static_cast<uint8_t>(payload.isEmpty() ? 0 : payload[0]);
+        }
+    });
+
+    double megabytes = static_cast<double>(text.size()) / (1024.0 * 1024.0);
+    std::printf("%zu lines, %.1f MiB, kernel %s\n", kLines, megabytes, hexDecoderName());
+    std::printf("payload hex, scalar table        %8.1f ms\n", scalarMs);
+    std::printf("payload hex, decodeHexRun        %8.1f ms  (%.1fx)\n", kernelMs, scalarMs / kernelMs);
+    std::printf("whole line, QString + regex      %8.1f ms  %7.1f MiB/s\n", qstringMs, megabytes * 1000.0 / qstringMs);
+    std::printf("whole line, CANLogParser         %8.1f ms  %7.1f MiB/s  (%.1fx)\n", parserMs,
+                megabytes * 1000.0 / parserMs, qstringMs / parserMs);
+    std::printf("(checksum %llu)\n", static_cast<unsigned long long>(checksum));
+
+    bool agree = scalarSum == kernelSum && parsed == kLines && qparsed == kLines;
+    if (!agree) {
+        std::printf("results disagree: %zu and %zu of %zu lines parsed\n", parsed, qparsed, kLines);
+    }
+    return agree ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// Batch signal decoding against per-frame MessageDecoder::decode, over one
+// ID with kFrames classic frames. Run from a Release build:
+//   cmake -DCANVIS_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release ..
+//   ./bench/signal_decode_bench
+
+#include "batch_signal_decoder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr size_t kFrames = 4000000;
+constexpr int kRepeats = 5;
+
+// Best of kRepeats, in milliseconds
+template <typename Fn>
+double bestMs(Fn &&fn)
+{
+    double best = 1e300;
+    for (int repeat = 0; repeat < kRepeats; ++repeat) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+DBCSignal makeSignal(const char *name, unsigned startBit, unsigned length, bool bigEndian, bool isSigned)
+{
+    DBCSignal signal;
+    signal.name = name;
+    signal.startBit = startBit;
+    signal.length = length;
+    signal.bigEndian = bigEndian;
+    signal.isSigned = isSigned;
+    signal.factor = 0.125;
+    signal.offset = -40.0;
+    return signal;
+}
+}
+
+int main()
+{
+    DBCMessage message;
+    message.id = 0x152;
+    message.name = "Bench";
+    message.size = 8;
+    message.messageSignals = {
+        makeSignal("speed", 0, 16, false, false),
+        makeSignal("torque", 16, 12, false, true),
+        makeSignal("angle", 39, 16, true, true),
+        makeSignal("flags", 56, 4, false, false),
+        makeSignal("counter", 60, 4, false, false),
+        makeSignal("pressure", 47, 10, true, false),
+        makeSignal("current", 28, 10, false, true),
+        makeSignal("mode", 7, 3, true, false),
+    };
+    MessageDecoder decoder(message);
+    size_t signals = decoder.signalCount();
+
+    CANFrameStore store;
+    std::vector<uint32_t> rows(kFrames);
+    std::mt19937 random(1);
+    for (size_t i = 0; i < kFrames; ++i) {
+        CANFrame frame;
+        frame.timestampNs = i * 1000;
+        frame.id = message.id;
+        frame.dlc = 8;
+        for (int b = 0; b < 8; ++b) {
+            frame.data[b] = static_cast<uint8_t>(random());
+        }
+        frame.interfaceName = "can0";
+        store.append(frame);
+        rows[i] = static_cast<uint32_t>(i);
+    }
+
+    std::vector<SignalColumnRequest> one(1);
+    one[0].rows = rows.data();
+    one[0].count = rows.size();
+    one[0].decoder = &decoder;
+    std::vector<SignalColumnRequest> all(signals, one[0]);
+    for (size_t s = 0; s < signals; ++s) {
+        all[s].signalIndex = s;
+    }
+
+    // Per frame: every signal of the message is decoded for each row
+    std::vector<double> perFrame(kFrames * signals);
+    double perFrameMs = bestMs([&]() {
+        double values[16];
+        bool present[16];
+        for (size_t i = 0; i < kFrames; ++i) {
+            decoder.decode(store.payload(rows[i]), store.dlc(rows[i]), values, present);
+            for (size_t s = 0; s < signals; ++s) {
+                perFrame[s * kFrames + i] = values[s];
+            }
+        }
+    });
+
+    // Per frame, one signal: pad the payload and extract just that signal
+    std::vector<double> oneSignal(kFrames);
+    double perFrameOneMs = bestMs([&]() {
+        uint8_t buffer[MessageDecoder::kBufferSize];
+        const SignalPlan &plan = decoder.plan(0);
+        for (size_t i = 0; i < kFrames; ++i) {
+            MessageDecoder::pad(store.payload(rows[i]), store.dlc(rows[i]), buffer);
+            oneSignal[i] = plan.physical(buffer);
+        }
+    });
+
+    std::vector<SignalColumn<double>> columns;
+    std::vector<SignalColumn<float>> floatColumns;
+    double oneDoubleMs = bestMs([&]() { columns = decodeSignalColumns<double>(store, one, 1); });
+    double oneFloatMs = bestMs([&]() { floatColumns = decodeSignalColumns<float>(store, one, 1); });
+    double allSingleMs = bestMs([&]() { columns = decodeSignalColumns<double>(store, all, 1); });
+    double allThreadsMs = bestMs([&]() { columns = decodeSignalColumns<double>(store, all); });
+
+    size_t mismatches = 0;
+    for (size_t s = 0; s < signals; ++s) {
+        for (size_t i = 0; i < kFrames; ++i) {
+            mismatches += columns[s].values[i] != perFrame[s * kFrames + i] || !columns[s].present[i];
+        }
+    }
+
+    std::printf("%zu frames, %zu signals, kernel %s, %u threads\n", kFrames, signals, batchDecoderName(),
+                std::thread::hardware_concurrency());
+    std::printf("per-frame decode, all signals     %8.1f ms\n", perFrameMs);
+    std::printf("per-frame decode, one signal      %8.1f ms\n", perFrameOneMs);
+    std::printf("batch, one signal, double         %8.1f ms  (%.1fx)\n", oneDoubleMs, perFrameOneMs / oneDoubleMs);
+    std::printf("batch, one signal, float          %8.1f ms\n", oneFloatMs);
+    std::printf("batch, all signals, 1 thread      %8.1f ms  (%.1fx)\n", allSingleMs, perFrameMs / allSingleMs);
+    std::printf("batch, all signals, all threads   %8.1f ms  (%.1fx)\n", allThreadsMs, perFrameMs / allThreadsMs);
+    std::printf("mismatches against per-frame      %8zu\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
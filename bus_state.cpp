@@ -0,0 +1,100 @@
+#include "bus_state.h"
+#include "can_id_index.h"
+
+#include <algorithm>
+
+BusStateIndex::BusStateIndex()
+    : standardSlots(kStandardSlots, kNoSlot)
+{
+}
+
+void BusStateIndex::clear()
+{
+    std::fill(standardSlots.begin(), standardSlots.end(), kNoSlot);
+    extendedSlots.clear();
+    slotKeys.clear();
+    current.clear();
+    checkpoints.clear();
+    checkpointInterval = kInitialInterval;
+    checkpointBytes = 0;
+    rowsIndexed = 0;
+}
+
+void BusStateIndex::setBudget(size_t bytes)
+{
+    budget = bytes;
+    thinCheckpoints();
+}
+
+uint32_t &BusStateIndex::slotOf(uint32_t key)
+{
+    if (key < kStandardSlots) {
+        return standardSlots[key];
+    }
+    return extendedSlots.try_emplace(key, kNoSlot).first->second;
+}
+
+uint32_t BusStateIndex::findSlot(uint32_t key) const
+{
+    if (key < kStandardSlots) {
+        return standardSlots[key];
+    }
+    auto it = extendedSlots.find(key);
+    return it == extendedSlots.end() ? kNoSlot : it->second;
+}
+
+void BusStateIndex::update(const CANFrameStore &store)
+{
+    const FrameColumn<uint32_t> &ids = store.ids();
+    const FrameColumn<uint8_t> &flags = store.flagColumn();
+
+    for (size_t row = rowsIndexed; row < ids.size(); ++row) {
+        if (row == checkpoints.size() * checkpointInterval) {
+            checkpoints.push_back(current);
+            checkpointBytes += current.size() * sizeof(uint32_t);
+            thinCheckpoints();
+        }
+
+        uint32_t key = CANIDIndex::keyOf(ids[row], flags[row]);
+        uint32_t &slot = slotOf(key);
+        if (slot == kNoSlot) {
+            slot = static_cast<uint32_t>(slotKeys.size());
+            slotKeys.push_back(key);
+            current.push_back(kNoRow);
+        }
+        current[slot] = static_cast<uint32_t>(row);
+    }
+    rowsIndexed = ids.size();
+}
+
+void BusStateIndex::thinCheckpoints()
+{
+    // Checkpoint 2k at the old interval is checkpoint k at the doubled one
+    while (checkpointBytes > budget && checkpoints.size() > 1) {
+        size_t kept = 0;
+        checkpointBytes = 0;
+        for (size_t k = 0; k < checkpoints.size(); k += 2) {
+            checkpointBytes += checkpoints[k].size() * sizeof(uint32_t);
+            checkpoints[kept++] = std::move(checkpoints[k]);
+        }
+        checkpoints.resize(kept);
+        checkpointInterval *= 2;
+    }
+}
+
+void BusStateIndex::stateAt(const CANFrameStore &store, size_t row, std::vector<uint32_t> &lastRows) const
+{
+    lastRows.assign(slotKeys.size(), kNoRow);
+    if (checkpoints.empty() || row >= rowsIndexed) {
+        return;
+    }
+
+    size_t checkpoint = std::min(row / checkpointInterval, checkpoints.size() - 1);
+    std::copy(checkpoints[checkpoint].begin(), checkpoints[checkpoint].end(), lastRows.begin());
+
+    const FrameColumn<uint32_t> &ids = store.ids();
+    const FrameColumn<uint8_t> &flags = store.flagColumn();
+    for (size_t replay = checkpoint * checkpointInterval; replay <= row; ++replay) {
+        lastRows[findSlot(CANIDIndex::keyOf(ids[replay], flags[replay]))] = static_cast<uint32_t>(replay);
+    }
+}
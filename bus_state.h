@@ -0,0 +1,65 @@
+#ifndef BUS_STATE_H
+#define BUS_STATE_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "frame_store.h"
+
+// Reconstructs the bus state (the last frame of every CAN ID) at any row.
+// The per-ID last-row table is checkpointed every interval() rows, so the
+// state at a row is a copy of the checkpoint before it plus a replay of at
+// most one interval. When the checkpoints outgrow their memory budget the
+// interval doubles and every other checkpoint is dropped, so memory stays
+// bounded however long the log is; the replay grows instead.
+class BusStateIndex
+{
+public:
+    static constexpr size_t kInitialInterval = 4096;
+    static constexpr size_t kDefaultBudget = 32 * 1024 * 1024;
+    static constexpr uint32_t kNoRow = UINT32_MAX;
+
+    BusStateIndex();
+
+    void clear();
+    void setBudget(size_t bytes);
+
+    // Indexes the frames appended to store since the last call
+    void update(const CANFrameStore &store);
+    size_t indexedRows() const { return rowsIndexed; }
+
+    // CANIDIndex keys in order of first appearance; state tables are indexed
+    // the same way
+    const std::vector<uint32_t> &keys() const { return slotKeys; }
+
+    // lastRows[i] becomes the last row at or before row with keys()[i], or
+    // kNoRow when that ID had not been seen yet. row must be indexed.
+    void stateAt(const CANFrameStore &store, size_t row, std::vector<uint32_t> &lastRows) const;
+
+    size_t interval() const { return checkpointInterval; }
+    size_t checkpointCount() const { return checkpoints.size(); }
+    size_t memoryUsage() const { return checkpointBytes; }
+
+private:
+    static constexpr uint32_t kStandardSlots = 0x1000;
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+    uint32_t &slotOf(uint32_t key);
+    uint32_t findSlot(uint32_t key) const;
+    void thinCheckpoints();
+
+    std::vector<uint32_t> standardSlots;
+    std::unordered_map<uint32_t, uint32_t> extendedSlots;
+    std::vector<uint32_t> slotKeys;
+
+    std::vector<uint32_t> current;  // state after every indexed row
+    std::vector<std::vector<uint32_t>> checkpoints;  // checkpoints[k]: state before row k * interval
+    size_t checkpointInterval = kInitialInterval;
+    size_t checkpointBytes = 0;
+    size_t budget = kDefaultBudget;
+    size_t rowsIndexed = 0;
+};
+
+#endif // BUS_STATE_H
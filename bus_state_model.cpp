@@ -0,0 +1,102 @@
+#include "bus_state_model.h"
+#include "can_id_index.h"
+#include "frame_format.h"
+
+#include <algorithm>
+
+BusStateModel::BusStateModel(const CANFrameStore *store, QObject *parent)
+    : QAbstractTableModel(parent)
+    , store(store)
+{
+}
+
+int BusStateModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(entries.size());
+}
+
+int BusStateModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnTotal;
+}
+
+QVariant BusStateModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    if (role == Qt::TextAlignmentRole && index.column() == ColumnAge) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const Entry &entry = entries[index.row()];
+    uint32_t row = entry.row;
+    switch (index.column()) {
+        case ColumnID:        return formatCANID(CANIDIndex::idOf(entry.key), CANIDIndex::flagsOf(entry.key));
+        case ColumnLastSeen:  return formatTimestamp(store->timestamp(row));
+        case ColumnAge: {
+            uint64_t seen = store->timestamp(row);
+            double ageNs = stateTimeNs > seen ? static_cast<double>(stateTimeNs - seen) : 0.0;
+            return QString::number(ageNs / 1e6, 'f', 3);
+        }
+        case ColumnData:      return formatPayload(store->payload(row), store->dlc(row), store->flags(row));
+        case ColumnInterface: return QString::fromStdString(store->interfaceName(row));
+        default:              return QVariant();
+    }
+}
+
+QVariant BusStateModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QVariant();
+    }
+
+    switch (section) {
+        case ColumnID:        return QStringLiteral("CAN ID");
+        case ColumnLastSeen:  return QStringLiteral("Last Seen");
+        case ColumnAge:       return QStringLiteral("Age (ms)");
+        case ColumnData:      return QStringLiteral("Data Bytes");
+        case ColumnInterface: return QStringLiteral("Interface");
+        default:              return QVariant();
+    }
+}
+
+void BusStateModel::setState(const std::vector<uint32_t> &keys, const std::vector<uint32_t> &lastRows, size_t row)
+{
+    std::vector<Entry> state;
+    state.reserve(keys.size());
+    for (size_t i = 0; i < keys.size() && i < lastRows.size(); ++i) {
+        if (lastRows[i] != BusStateIndex::kNoRow) {
+            state.push_back({keys[i], lastRows[i]});
+        }
+    }
+    std::sort(state.begin(), state.end(), [](const Entry &a, const Entry &b) { return a.key < b.key; });
+    stateTimeNs = row < store->size() ? store->timestamp(row) : 0;
+
+    // While the same IDs stay on the bus only the cells change, which keeps
+    // the view's selection and scroll position during playback
+    bool sameKeys = state.size() == entries.size()
+                 && std::equal(state.begin(), state.end(), entries.begin(),
+                               [](const Entry &a, const Entry &b) { return a.key == b.key; });
+    if (sameKeys) {
+        entries.swap(state);
+        if (!entries.empty()) {
+            emit dataChanged(index(0, 0), index(rowCount() - 1, ColumnTotal - 1));
+        }
+        return;
+    }
+    beginResetModel();
+    entries.swap(state);
+    endResetModel();
+}
+
+void BusStateModel::clear()
+{
+    beginResetModel();
+    entries.clear();
+    stateTimeNs = 0;
+    endResetModel();
+}
@@ -0,0 +1,51 @@
+#ifndef BUS_STATE_MODEL_H
+#define BUS_STATE_MODEL_H
+#pragma once
+
+#include <QAbstractTableModel>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "bus_state.h"
+#include "frame_store.h"
+
+// Table of the bus state at one row: the last frame of every ID seen up to
+// it, by ID, with how long before that row it arrived. Cells are formatted
+// from the store when drawn.
+class BusStateModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColumnID,
+        ColumnLastSeen,
+        ColumnAge,
+        ColumnData,
+        ColumnInterface,
+        ColumnTotal
+    };
+
+    explicit BusStateModel(const CANFrameStore *store, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Shows the state at row; keys and lastRows as from BusStateIndex
+    void setState(const std::vector<uint32_t> &keys, const std::vector<uint32_t> &lastRows, size_t row);
+    void clear();
+
+private:
+    struct Entry {
+        uint32_t key;
+        uint32_t row;
+    };
+
+    const CANFrameStore *store;
+    std::vector<Entry> entries;  // ascending key
+    uint64_t stateTimeNs = 0;
+};
+
+#endif // BUS_STATE_MODEL_H
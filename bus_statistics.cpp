@@ -0,0 +1,178 @@
+#include "bus_statistics.h"
+#include "can_id_index.h"
+
+#include <thread>
+
+namespace {
+
+// Rows below this are reduced on the calling thread
+constexpr size_t kMinRowsPerThread = 256 * 1024;
+
+constexpr uint8_t kCodeLengths[IDStatistics::kDLCCodes] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+} // namespace
+
+int IDStatistics::dlcCode(uint8_t length)
+{
+    if (length <= 8) {
+        return length;
+    }
+    const uint8_t *code = std::lower_bound(kCodeLengths + 9, kCodeLengths + kDLCCodes, length);
+    return code == kCodeLengths + kDLCCodes ? kDLCCodes - 1 : static_cast<int>(code - kCodeLengths);
+}
+
+uint8_t IDStatistics::codeLength(int code)
+{
+    return kCodeLengths[code];
+}
+
+uint32_t BusStatistics::frameBits(uint8_t length, uint8_t flags)
+{
+    // SOF, arbitration, control, CRC, delimiters, ACK, EOF and interframe
+    // space: 47 bits with an 11-bit ID, 67 with a 29-bit one. FD frames carry
+    // a longer CRC.
+    uint32_t bits = (flags & FrameExtended) ? 67 : 47;
+    if (flags & FrameFD) {
+        bits += length > 16 ? 6 : 2;
+    }
+    if (!(flags & FrameRemote)) {
+        bits += 8U * length;
+    }
+    return bits;
+}
+
+BusStatistics::BusStatistics()
+    : standardSlots(kStandardSlots, kNoEntry)
+{
+}
+
+void BusStatistics::clear()
+{
+    std::fill(standardSlots.begin(), standardSlots.end(), kNoEntry);
+    extendedSlots.clear();
+    entries.clear();
+    interfaceTotals.clear();
+    rowsProcessed = 0;
+}
+
+IDStatistics &BusStatistics::entryFor(uint32_t key)
+{
+    uint32_t *slot;
+    if (key < kStandardSlots) {
+        slot = &standardSlots[key];
+    } else {
+        slot = &extendedSlots.try_emplace(key, kNoEntry).first->second;
+    }
+    if (*slot == kNoEntry) {
+        *slot = static_cast<uint32_t>(entries.size());
+        entries.emplace_back().key = key;
+    }
+    return entries[*slot];
+}
+
+void BusStatistics::reduce(const CANFrameStore &store, size_t firstRow, size_t lastRow)
+{
+    const uint64_t *timestamps = store.timestamps().data();
+    const uint32_t *ids = store.ids().data();
+    const uint8_t *dlcs = store.dlcs().data();
+    const uint8_t *flags = store.flagColumn().data();
+    const uint8_t *interfaces = store.interfaceIndices().data();
+    interfaceTotals.resize(store.interfaceNames().size());
+
+    uint32_t lastKey = kNoEntry;
+    IDStatistics *stats = nullptr;
+    for (size_t row = firstRow; row < lastRow; ++row) {
+        uint64_t timestamp = timestamps[row];
+        uint32_t key = CANIDIndex::keyOf(ids[row], flags[row]);
+        if (key != lastKey) {
+            stats = &entryFor(key);
+            lastKey = key;
+        }
+
+        if (stats->count == 0) {
+            stats->firstSeenNs = timestamp;
+        } else {
+            uint64_t period = timestamp > stats->lastSeenNs ? timestamp - stats->lastSeenNs : 0;
+            stats->minPeriodNs = std::min(stats->minPeriodNs, period);
+            stats->maxPeriodNs = std::max(stats->maxPeriodNs, period);
+            stats->periodSumSquares += static_cast<double>(period) * static_cast<double>(period);
+        }
+        stats->lastSeenNs = timestamp;
+        ++stats->count;
+        ++stats->dlcCounts[IDStatistics::dlcCode(dlcs[row])];
+
+        InterfaceStatistics &bus = interfaceTotals[interfaces[row]];
+        ++bus.frames;
+        bus.bits += frameBits(dlcs[row], flags[row]);
+        bus.firstSeenNs = std::min(bus.firstSeenNs, timestamp);
+        bus.lastSeenNs = std::max(bus.lastSeenNs, timestamp);
+    }
+}
+
+void BusStatistics::merge(const BusStatistics &later)
+{
+    // Every frame in later comes after every frame here, so each ID gains
+    // one period across the boundary
+    for (const IDStatistics &next : later.entries) {
+        IDStatistics &stats = entryFor(next.key);
+        if (stats.count == 0) {
+            stats = next;
+            continue;
+        }
+        uint64_t gap = next.firstSeenNs > stats.lastSeenNs ? next.firstSeenNs - stats.lastSeenNs : 0;
+        stats.minPeriodNs = std::min({stats.minPeriodNs, next.minPeriodNs, gap});
+        stats.maxPeriodNs = std::max({stats.maxPeriodNs, next.maxPeriodNs, gap});
+        stats.periodSumSquares += next.periodSumSquares + static_cast<double>(gap) * static_cast<double>(gap);
+        stats.count += next.count;
+        stats.lastSeenNs = next.lastSeenNs;
+        for (int code = 0; code < IDStatistics::kDLCCodes; ++code) {
+            stats.dlcCounts[code] += next.dlcCounts[code];
+        }
+    }
+
+    if (interfaceTotals.size() < later.interfaceTotals.size()) {
+        interfaceTotals.resize(later.interfaceTotals.size());
+    }
+    for (size_t i = 0; i < later.interfaceTotals.size(); ++i) {
+        const InterfaceStatistics &next = later.interfaceTotals[i];
+        InterfaceStatistics &bus = interfaceTotals[i];
+        bus.frames += next.frames;
+        bus.bits += next.bits;
+        bus.firstSeenNs = std::min(bus.firstSeenNs, next.firstSeenNs);
+        bus.lastSeenNs = std::max(bus.lastSeenNs, next.lastSeenNs);
+    }
+}
+
+void BusStatistics::update(const CANFrameStore &store, int threads)
+{
+    size_t firstRow = rowsProcessed;
+    size_t rows = store.size() > firstRow ? store.size() - firstRow : 0;
+    if (rows == 0) {
+        return;
+    }
+
+    size_t workers = threads > 0 ? static_cast<size_t>(threads)
+                                 : std::max<size_t>(1, std::thread::hardware_concurrency());
+    workers = std::max<size_t>(1, std::min(workers, rows / kMinRowsPerThread));
+
+    std::vector<BusStatistics> partial(workers);
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (size_t w = 0; w < workers; ++w) {
+        size_t begin = firstRow + rows * w / workers;
+        size_t end = firstRow + rows * (w + 1) / workers;
+        if (workers == 1) {
+            partial[w].reduce(store, begin, end);
+        } else {
+            pool.emplace_back([&store, &partial, w, begin, end]() { partial[w].reduce(store, begin, end); });
+        }
+    }
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    for (const BusStatistics &part : partial) {
+        merge(part);
+    }
+    rowsProcessed = store.size();
+}
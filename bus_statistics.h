@@ -0,0 +1,106 @@
+#ifndef BUS_STATISTICS_H
+#define BUS_STATISTICS_H
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "frame_store.h"
+
+// Traffic figures for one CAN ID (a CANIDIndex key). Periods are the gaps
+// between consecutive frames of the ID in store order.
+struct IDStatistics {
+    // Payload lengths are counted per DLC code, 0..8 then 12, 16, 20, 24, 32, 48, 64
+    static constexpr int kDLCCodes = 16;
+
+    uint32_t key = 0;
+    uint64_t count = 0;
+    uint64_t firstSeenNs = 0;
+    uint64_t lastSeenNs = 0;
+    uint64_t minPeriodNs = UINT64_MAX;
+    uint64_t maxPeriodNs = 0;
+    double periodSumSquares = 0.0;  // ns^2, for the jitter
+    uint64_t dlcCounts[kDLCCodes] = {};
+
+    uint64_t periods() const { return count > 1 ? count - 1 : 0; }
+    double meanPeriodNs() const
+    {
+        return periods() ? static_cast<double>(lastSeenNs - firstSeenNs) / periods() : 0.0;
+    }
+    // Standard deviation of the period
+    double jitterNs() const
+    {
+        if (!periods()) {
+            return 0.0;
+        }
+        double mean = meanPeriodNs();
+        return std::sqrt(std::max(0.0, periodSumSquares / periods() - mean * mean));
+    }
+
+    static int dlcCode(uint8_t length);
+    static uint8_t codeLength(int code);
+};
+
+// Bus load inputs for one interface
+struct InterfaceStatistics {
+    uint64_t frames = 0;
+    uint64_t bits = 0;              // estimated bits on the wire, without stuffing
+    uint64_t firstSeenNs = UINT64_MAX;
+    uint64_t lastSeenNs = 0;
+
+    // Share of the bus used at bitrate over the interface's active time, 0..1
+    double load(uint64_t bitrate) const
+    {
+        if (lastSeenNs <= firstSeenNs || bitrate == 0) {
+            return 0.0;
+        }
+        double seconds = static_cast<double>(lastSeenNs - firstSeenNs) * 1e-9;
+        return static_cast<double>(bits) / (static_cast<double>(bitrate) * seconds);
+    }
+};
+
+// Per-ID and per-interface statistics over a CANFrameStore. The rows not yet
+// seen are split into contiguous ranges, each range is reduced on its own
+// thread in a single pass, and the partial results are merged in row order.
+// The same merge folds every update into the running totals, so appending
+// frames costs only the new rows.
+class BusStatistics
+{
+public:
+    BusStatistics();
+
+    void clear();
+
+    // Accounts for the frames appended to store since the last call.
+    // threads <= 0 uses every core.
+    void update(const CANFrameStore &store, int threads = 0);
+
+    // One entry per ID, in order of first appearance
+    const std::vector<IDStatistics> &ids() const { return entries; }
+    // Indexed like store.interfaceNames()
+    const std::vector<InterfaceStatistics> &interfaces() const { return interfaceTotals; }
+    size_t processedRows() const { return rowsProcessed; }
+
+    // Estimated frame length on the wire: header, CRC and trailer bits plus
+    // the payload, ignoring bit stuffing
+    static uint32_t frameBits(uint8_t length, uint8_t flags);
+
+private:
+    static constexpr uint32_t kStandardSlots = 0x1000;
+    static constexpr uint32_t kNoEntry = UINT32_MAX;
+
+    IDStatistics &entryFor(uint32_t key);
+    void reduce(const CANFrameStore &store, size_t firstRow, size_t lastRow);
+    void merge(const BusStatistics &later);
+
+    std::vector<uint32_t> standardSlots;
+    std::unordered_map<uint32_t, uint32_t> extendedSlots;
+    std::vector<IDStatistics> entries;
+    std::vector<InterfaceStatistics> interfaceTotals;
+    size_t rowsProcessed = 0;
+};
+
+#endif // BUS_STATISTICS_H
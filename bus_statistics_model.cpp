@@ -0,0 +1,143 @@
+#include "bus_statistics_model.h"
+#include "can_id_index.h"
+#include "frame_format.h"
+
+#include <algorithm>
+
+namespace {
+
+QString formatPeriod(double periodNs)
+{
+    return QString::number(periodNs / 1e6, 'f', 3);
+}
+
+// "8: 1200, 4: 3" for the payload lengths an ID was seen with, most used first
+QString formatDLCs(const IDStatistics &stats)
+{
+    std::vector<int> codes;
+    for (int code = 0; code < IDStatistics::kDLCCodes; ++code) {
+        if (stats.dlcCounts[code] > 0) {
+            codes.push_back(code);
+        }
+    }
+    std::sort(codes.begin(), codes.end(),
+              [&stats](int a, int b) { return stats.dlcCounts[a] > stats.dlcCounts[b]; });
+
+    QStringList parts;
+    for (int code : codes) {
+        parts << QString("%1: %2").arg(IDStatistics::codeLength(code)).arg(stats.dlcCounts[code]);
+    }
+    return parts.join(", ");
+}
+
+// Value a column sorts by
+double sortKey(const IDStatistics &stats, int column)
+{
+    switch (column) {
+        case BusStatisticsModel::ColumnCount:      return static_cast<double>(stats.count);
+        case BusStatisticsModel::ColumnMeanPeriod: return stats.meanPeriodNs();
+        case BusStatisticsModel::ColumnMinPeriod:  return stats.periods() ? static_cast<double>(stats.minPeriodNs) : 0.0;
+        case BusStatisticsModel::ColumnMaxPeriod:  return static_cast<double>(stats.maxPeriodNs);
+        case BusStatisticsModel::ColumnJitter:     return stats.jitterNs();
+        case BusStatisticsModel::ColumnDLC: {
+            int code = static_cast<int>(std::max_element(stats.dlcCounts, stats.dlcCounts + IDStatistics::kDLCCodes)
+                                        - stats.dlcCounts);
+            return IDStatistics::codeLength(code);
+        }
+        case BusStatisticsModel::ColumnFirstSeen:  return static_cast<double>(stats.firstSeenNs);
+        case BusStatisticsModel::ColumnLastSeen:   return static_cast<double>(stats.lastSeenNs);
+        default:                                   return static_cast<double>(stats.key);
+    }
+}
+
+} // namespace
+
+BusStatisticsModel::BusStatisticsModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int BusStatisticsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+int BusStatisticsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnTotal;
+}
+
+QVariant BusStatisticsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    if (role == Qt::TextAlignmentRole && index.column() != ColumnID && index.column() != ColumnDLC) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const IDStatistics &stats = rows[index.row()];
+    switch (index.column()) {
+        case ColumnID:         return formatCANID(CANIDIndex::idOf(stats.key), CANIDIndex::flagsOf(stats.key));
+        case ColumnCount:      return QString::number(stats.count);
+        case ColumnMeanPeriod: return stats.periods() ? formatPeriod(stats.meanPeriodNs()) : QString();
+        case ColumnMinPeriod:  return stats.periods() ? formatPeriod(static_cast<double>(stats.minPeriodNs)) : QString();
+        case ColumnMaxPeriod:  return stats.periods() ? formatPeriod(static_cast<double>(stats.maxPeriodNs)) : QString();
+        case ColumnJitter:     return stats.periods() ? formatPeriod(stats.jitterNs()) : QString();
+        case ColumnDLC:        return formatDLCs(stats);
+        case ColumnFirstSeen:  return formatTimestamp(stats.firstSeenNs);
+        case ColumnLastSeen:   return formatTimestamp(stats.lastSeenNs);
+        default:               return QVariant();
+    }
+}
+
+QVariant BusStatisticsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QVariant();
+    }
+
+    switch (section) {
+        case ColumnID:         return QStringLiteral("CAN ID");
+        case ColumnCount:      return QStringLiteral("Frames");
+        case ColumnMeanPeriod: return QStringLiteral("Mean Period (ms)");
+        case ColumnMinPeriod:  return QStringLiteral("Min Period (ms)");
+        case ColumnMaxPeriod:  return QStringLiteral("Max Period (ms)");
+        case ColumnJitter:     return QStringLiteral("Jitter (ms)");
+        case ColumnDLC:        return QStringLiteral("Lengths");
+        case ColumnFirstSeen:  return QStringLiteral("First Seen");
+        case ColumnLastSeen:   return QStringLiteral("Last Seen");
+        default:               return QVariant();
+    }
+}
+
+void BusStatisticsModel::sort(int column, Qt::SortOrder order)
+{
+    sortColumn = column;
+    sortOrder = order;
+    emit layoutAboutToBeChanged();
+    applySort();
+    emit layoutChanged();
+}
+
+void BusStatisticsModel::refresh(const BusStatistics &statistics)
+{
+    beginResetModel();
+    rows = statistics.ids();
+    applySort();
+    endResetModel();
+}
+
+void BusStatisticsModel::applySort()
+{
+    int column = sortColumn;
+    bool ascending = sortOrder == Qt::AscendingOrder;
+    std::stable_sort(rows.begin(), rows.end(), [column, ascending](const IDStatistics &a, const IDStatistics &b) {
+        double keyA = sortKey(a, column);
+        double keyB = sortKey(b, column);
+        return ascending ? keyA < keyB : keyB < keyA;
+    });
+}
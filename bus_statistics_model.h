@@ -0,0 +1,49 @@
+#ifndef BUS_STATISTICS_MODEL_H
+#define BUS_STATISTICS_MODEL_H
+#pragma once
+
+#include <QAbstractTableModel>
+#include <vector>
+#include "bus_statistics.h"
+
+// Table of per-ID statistics for the statistics tab. Holds a copy of the
+// figures taken by refresh(), so the engine can keep updating underneath,
+// and sorts on any column.
+class BusStatisticsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColumnID,
+        ColumnCount,
+        ColumnMeanPeriod,
+        ColumnMinPeriod,
+        ColumnMaxPeriod,
+        ColumnJitter,
+        ColumnDLC,
+        ColumnFirstSeen,
+        ColumnLastSeen,
+        ColumnTotal
+    };
+
+    explicit BusStatisticsModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // Takes a fresh copy of statistics' per-ID figures, keeping the sort order
+    void refresh(const BusStatistics &statistics);
+
+private:
+    void applySort();
+
+    std::vector<IDStatistics> rows;
+    int sortColumn = ColumnID;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+};
+
+#endif // BUS_STATISTICS_MODEL_H
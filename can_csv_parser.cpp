@@ -0,0 +1,415 @@
+#include "can_csv_parser.h"
+#include "hex_decode.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr int kMaxFields = CANCSVParser::kMaxFields;
+constexpr uint32_t kIdMask = 0x1FFFFFFFU;
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline char toLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+std::string_view trim(std::string_view field)
+{
+    while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) field.remove_prefix(1);
+    while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r')) field.remove_suffix(1);
+    return field;
+}
+
+// Splits one record into fields and returns the start of the next record.
+// Quoted fields may contain delimiters and newlines; doubled quotes inside
+// them are left as-is since none of the CAN columns can contain one.
+const char *splitRecord(const char *p, const char *end, char delimiter,
+                        std::string_view *fields, int &count)
+{
+    count = 0;
+    for (;;) {
+        const char *fieldBegin;
+        const char *fieldEnd;
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        if (p < end && *p == '"') {
+            fieldBegin = ++p;
+            while (p < end) {
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') {
+                        p += 2;
+                        continue;
+                    }
+                    break;
+                }
+                ++p;
+            }
+            fieldEnd = p;
+            if (p < end) ++p;  // closing quote
+            while (p < end && *p != delimiter && *p != '\n') ++p;
+        } else {
+            fieldBegin = p;
+            while (p < end && *p != delimiter && *p != '\n') ++p;
+            fieldEnd = p;
+        }
+
+        if (count < kMaxFields) {
+            fields[count++] = trim(std::string_view(fieldBegin, static_cast<size_t>(fieldEnd - fieldBegin)));
+        }
+        if (p >= end) return end;
+        if (*p == '\n') return p + 1;
+        ++p;  // delimiter
+    }
+}
+
+// Column name reduced to lower-case letters and digits: "Time Stamp" -> "timestamp"
+std::string normalizeName(std::string_view name)
+{
+    std::string normalized;
+    for (char c : name) {
+        char lower = toLower(c);
+        if ((lower >= 'a' && lower <= 'z') || isDigit(lower)) normalized += lower;
+    }
+    // "ID (hex)", "Data (hex)"
+    if (normalized.size() > 3 && normalized.compare(normalized.size() - 3, 3, "hex") == 0) {
+        normalized.resize(normalized.size() - 3);
+    }
+    return normalized;
+}
+
+bool startsWith(const std::string &s, const char *prefix)
+{
+    return s.rfind(prefix, 0) == 0;
+}
+
+bool endsWith(const std::string &s, const char *suffix)
+{
+    size_t length = std::strlen(suffix);
+    return s.size() >= length && s.compare(s.size() - length, length, suffix) == 0;
+}
+
+bool isOneOf(const std::string &s, std::initializer_list<const char *> names)
+{
+    for (const char *name : names) {
+        if (s == name) return true;
+    }
+    return false;
+}
+
+// "D1", "Data3", "B0", "Byte7": index of a per-byte payload column, or -1
+int byteColumnIndex(const std::string &name)
+{
+    size_t digits = name.size();
+    while (digits > 0 && isDigit(name[digits - 1])) --digits;
+    if (digits == name.size() || name.size() - digits > 2) return -1;
+    std::string prefix = name.substr(0, digits);
+    if (!isOneOf(prefix, {"d", "data", "b", "byte", "db"})) return -1;
+    return std::stoi(name.substr(digits));
+}
+
+// Unsigned decimal with optional fraction, scaled to integer nanoseconds
+bool parseTimestamp(std::string_view field, uint64_t scaleNs, uint64_t &timestampNs)
+{
+    size_t i = 0;
+    uint64_t whole = 0;
+    while (i < field.size() && isDigit(field[i])) whole = whole * 10 + static_cast<uint64_t>(field[i++] - '0');
+    if (i == 0) return false;
+
+    uint64_t fraction = 0;
+    uint64_t fractionScale = 1;
+    if (i < field.size() && (field[i] == '.' || field[i] == ',')) {
+        ++i;
+        while (i < field.size() && isDigit(field[i])) {
+            if (fractionScale < 1000000000ULL) {
+                fraction = fraction * 10 + static_cast<uint64_t>(field[i] - '0');
+                fractionScale *= 10;
+            }
+            ++i;
+        }
+    }
+    if (i != field.size()) return false;
+    timestampNs = whole * scaleNs + fraction * scaleNs / fractionScale;
+    return true;
+}
+
+bool parseUnsigned(std::string_view field, uint32_t &value)
+{
+    if (field.empty()) return false;
+    value = 0;
+    for (char c : field) {
+        if (!isDigit(c)) return false;
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return true;
+}
+
+// Hex identifier, optionally written as "0x1A0" or "1A0h"
+bool parseID(std::string_view field, uint32_t &id, size_t &digits)
+{
+    if (field.size() > 2 && field[0] == '0' && (field[1] == 'x' || field[1] == 'X')) field.remove_prefix(2);
+    if (!field.empty() && (field.back() == 'h' || field.back() == 'H')) field.remove_suffix(1);
+    if (field.empty() || field.size() > 8) return false;
+    id = 0;
+    for (char c : field) {
+        uint8_t v = hexDigitValue(c);
+        if (v == 0xFF) return false;
+        id = (id << 4) | v;
+    }
+    digits = field.size();
+    return true;
+}
+
+bool parseBool(std::string_view field)
+{
+    return !field.empty() && (field[0] == '1' || toLower(field[0]) == 't' || toLower(field[0]) == 'y');
+}
+
+// Payload written as one field: "01 02 A0", "0102A0" or "1-2-A0"
+bool parseDataField(std::string_view field, uint8_t *out, size_t maxBytes, size_t &length)
+{
+    const char *p = field.data();
+    const char *end = p + field.size();
+    length = 0;
+    while (p < end) {
+        if (hexDigitValue(*p) == 0xFF) {
+            if (*p != ' ' && *p != '-' && *p != ':' && *p != '.') return false;
+            ++p;
+            continue;
+        }
+        const char *token = p;
+        while (p < end && hexDigitValue(*p) != 0xFF) ++p;
+        size_t tokenLength = static_cast<size_t>(p - token);
+        if (tokenLength == 1) {
+            // Some exporters drop the leading zero of single-digit bytes
+            if (length == maxBytes) return false;
+            out[length++] = hexDigitValue(*token);
+            continue;
+        }
+        if (tokenLength % 2 != 0 || length + tokenLength / 2 > maxBytes) return false;
+        length += decodeHexRun(token, p, out + length, maxBytes - length);
+    }
+    return true;
+}
+
+// Flag words from "Type"/"Flags" columns
+uint8_t parseTypeFlags(std::string_view field)
+{
+    uint8_t flags = 0;
+    size_t i = 0;
+    while (i < field.size()) {
+        while (i < field.size() && !std::isalnum(static_cast<unsigned char>(field[i]))) ++i;
+        size_t start = i;
+        while (i < field.size() && std::isalnum(static_cast<unsigned char>(field[i]))) ++i;
+        std::string word;
+        for (size_t j = start; j < i; ++j) word += toLower(field[j]);
+        if (isOneOf(word, {"x", "ext", "xtd", "extended", "eff"})) flags |= FrameExtended;
+        else if (isOneOf(word, {"r", "rtr", "remote"})) flags |= FrameRemote;
+        else if (isOneOf(word, {"fd", "fdf"})) flags |= FrameFD;
+        else if (word == "brs") flags |= FrameBRS;
+        else if (word == "esi") flags |= FrameESI;
+        else if (isOneOf(word, {"err", "error", "errorframe"})) flags |= FrameError;
+    }
+    return flags;
+}
+
+} // namespace
+
+CANCSVParser::CANCSVParser(const char *begin, const char *end, const CSVSchema &schema)
+    : dataBegin(begin)
+    , cursor(begin)
+    , dataEnd(end)
+    , schema(schema)
+{
+}
+
+bool CANCSVParser::next(CANFrame &frame)
+{
+    while (cursor < dataEnd) {
+        int count = 0;
+        cursor = splitRecord(cursor, dataEnd, schema.delimiter, fields, count);
+        if (count == 1 && fields[0].empty()) {
+            continue;  // blank line
+        }
+        if (parseRecord(fields, count, frame)) {
+            return true;
+        }
+        ++malformed;
+    }
+    return false;
+}
+
+bool CANCSVParser::parseRecord(const std::string_view *fields, int count, CANFrame &frame)
+{
+    if (schema.timestampColumn >= count || schema.idColumn >= count) return false;
+
+    if (!parseTimestamp(fields[schema.timestampColumn], schema.timestampScaleNs, frame.timestampNs)) return false;
+
+    size_t idDigits = 0;
+    if (!parseID(fields[schema.idColumn], frame.id, idDigits)) return false;
+
+    frame.flags = 0;
+    if (schema.typeColumn >= 0 && schema.typeColumn < count) {
+        frame.flags = parseTypeFlags(fields[schema.typeColumn]);
+    }
+    if (schema.extendedColumn >= 0 && schema.extendedColumn < count) {
+        if (parseBool(fields[schema.extendedColumn])) frame.flags |= FrameExtended;
+    } else if (idDigits > 3 || frame.id > 0x7FF) {
+        // A Type column often only says Rx/Tx, so the ID's width decides
+        // whenever nothing marked the frame extended explicitly
+        frame.flags |= FrameExtended;
+    }
+    frame.id &= kIdMask;
+
+    uint32_t dlc = 0;
+    bool hasDLC = schema.dlcColumn >= 0 && schema.dlcColumn < count
+                  && parseUnsigned(fields[schema.dlcColumn], dlc);
+    size_t maxBytes = (frame.flags & FrameFD) || dlc > 8 ? 64 : 8;
+
+    size_t length = 0;
+    if (schema.dataColumn >= 0) {
+        if (schema.dataColumn < count
+            && !parseDataField(fields[schema.dataColumn], frame.data, maxBytes, length)) {
+            return false;
+        }
+    } else {
+        // One column per byte; stop at the DLC or at the first empty column
+        size_t limit = hasDLC ? std::min<size_t>(dlc, schema.byteColumnCount) : schema.byteColumnCount;
+        for (size_t i = 0; i < limit && length < maxBytes; ++i) {
+            int column = schema.byteColumns[i];
+            if (column >= count || fields[column].empty()) break;
+            size_t byteLength = 0;
+            if (!parseDataField(fields[column], frame.data + length, 1, byteLength)) return false;
+            length += byteLength;
+        }
+    }
+
+    if (frame.flags & FrameRemote) {
+        frame.dlc = static_cast<uint8_t>(std::min<uint32_t>(dlc, 8));
+    } else {
+        if (hasDLC && dlc < length) length = dlc;
+        frame.dlc = static_cast<uint8_t>(length);
+    }
+
+    // Numeric bus/channel numbers become "canN" so they match candump names
+    std::string_view iface = "csv";
+    if (schema.interfaceColumn >= 0 && schema.interfaceColumn < count && !fields[schema.interfaceColumn].empty()) {
+        iface = fields[schema.interfaceColumn];
+        uint32_t bus = 0;
+        if (parseUnsigned(iface, bus)) {
+            int written = std::snprintf(interfaceBuffer, sizeof(interfaceBuffer), "can%u", bus);
+            iface = std::string_view(interfaceBuffer, static_cast<size_t>(written));
+        }
+    }
+    frame.interfaceName = iface;
+    return true;
+}
+
+CSVSchema CANCSVParser::detectSchema(std::string_view firstLine, int &headerLines)
+{
+    CSVSchema schema;
+
+    // The delimiter is whichever candidate the first line uses most
+    size_t best = 0;
+    for (char candidate : {',', ';', '\t'}) {
+        size_t uses = 0;
+        for (char c : firstLine) uses += (c == candidate);
+        if (uses > best) {
+            best = uses;
+            schema.delimiter = candidate;
+        }
+    }
+
+    std::string_view fields[kMaxFields];
+    int count = 0;
+    splitRecord(firstLine.data(), firstLine.data() + firstLine.size(), schema.delimiter, fields, count);
+    schema.columnCount = count;
+
+    // No column names: assume the frame table layout
+    if (count > 0 && !fields[0].empty() && isDigit(fields[0][0])) {
+        headerLines = 0;
+        schema.timestampColumn = 0;
+        schema.idColumn = 1;
+        schema.dataColumn = count > 2 ? 2 : -1;
+        schema.interfaceColumn = count > 3 ? 3 : -1;
+        return schema;
+    }
+    headerLines = 1;
+
+    std::string timestampName;
+    bool hasBus = false;
+    bool hasMessageNumber = false;
+    bool hasChannel = false;
+    int byteIndices[CSVSchema::kMaxByteColumns];
+
+    for (int column = 0; column < count; ++column) {
+        std::string name = normalizeName(fields[column]);
+        int byteIndex = byteColumnIndex(name);
+
+        if (byteIndex >= 0 && schema.byteColumnCount < CSVSchema::kMaxByteColumns) {
+            byteIndices[schema.byteColumnCount] = byteIndex;
+            schema.byteColumns[schema.byteColumnCount++] = column;
+        } else if (schema.timestampColumn < 0 && startsWith(name, "time")) {
+            schema.timestampColumn = column;
+            timestampName = name;
+        } else if (schema.idColumn < 0 && isOneOf(name, {"id", "canid", "identifier", "arbid", "arbitrationid",
+                                                          "msgid", "messageid", "frameid"})) {
+            schema.idColumn = column;
+        } else if (schema.dlcColumn < 0 && isOneOf(name, {"len", "length", "dlc", "datalength",
+                                                           "datalengthcode", "bytecount"})) {
+            schema.dlcColumn = column;
+        } else if (schema.dataColumn < 0 && isOneOf(name, {"data", "databytes", "payload", "canbytes", "bytes"})) {
+            schema.dataColumn = column;
+        } else if (schema.interfaceColumn < 0 && isOneOf(name, {"bus", "channel", "chn", "ch", "interface",
+                                                                 "iface", "port", "description"})) {
+            schema.interfaceColumn = column;
+            hasBus |= name == "bus";
+            hasChannel |= name == "chn";
+        } else if (schema.extendedColumn < 0 && isOneOf(name, {"extended", "ext", "isextended", "ide"})) {
+            schema.extendedColumn = column;
+        } else if (schema.typeColumn < 0 && isOneOf(name, {"type", "flags", "frametype", "msgtype"})) {
+            schema.typeColumn = column;
+        } else if (name == "messagenumber") {
+            hasMessageNumber = true;
+        }
+    }
+
+    // Per-byte columns may be numbered from 0 or 1 and listed in any order
+    for (int i = 1; i < schema.byteColumnCount; ++i) {
+        for (int j = i; j > 0 && byteIndices[j - 1] > byteIndices[j]; --j) {
+            std::swap(byteIndices[j - 1], byteIndices[j]);
+            std::swap(schema.byteColumns[j - 1], schema.byteColumns[j]);
+        }
+    }
+    // A single-field payload wins over stray per-byte columns
+    if (schema.dataColumn >= 0) {
+        schema.byteColumnCount = 0;
+    }
+
+    // Units come from the column name when it has one
+    if (endsWith(timestampName, "ns")) schema.timestampScaleNs = 1ULL;
+    else if (endsWith(timestampName, "us")) schema.timestampScaleNs = 1000ULL;
+    else if (endsWith(timestampName, "ms")) schema.timestampScaleNs = 1000000ULL;
+
+    if (timestampName == "timestamp" && hasBus && schema.extendedColumn >= 0) {
+        // SavvyCAN: "Time Stamp,ID,Extended,Dir,Bus,LEN,D1..D8", microseconds
+        schema.exporter = "SavvyCAN";
+        schema.timestampScaleNs = 1000ULL;
+    } else if (hasMessageNumber) {
+        // PCAN-View: "Message Number;Time Offset (ms);Type;ID (hex);Data Length;Data (hex)"
+        schema.exporter = "PCAN";
+    } else if (hasChannel && schema.typeColumn >= 0) {
+        // Kvaser: "Chn,Identifier,Flags,DLC,D0..D7,Time", seconds
+        schema.exporter = "Kvaser";
+    }
+    return schema;
+}
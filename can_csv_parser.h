@@ -0,0 +1,67 @@
+#ifndef CAN_CSV_PARSER_H
+#define CAN_CSV_PARSER_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "can_log_parser.h"
+
+// Where the CAN fields live in a CSV export, worked out from its header line
+struct CSVSchema {
+    static constexpr int kMaxByteColumns = 64;
+
+    char delimiter = ',';
+    int timestampColumn = -1;
+    int idColumn = -1;
+    int dlcColumn = -1;
+    int dataColumn = -1;          // all payload bytes in one field
+    int interfaceColumn = -1;
+    int extendedColumn = -1;      // true/false or 1/0
+    int typeColumn = -1;          // free-form flags: "Ext", "X", "RTR", "FD", ...
+    int byteColumns[kMaxByteColumns];  // one field per payload byte (D1..D8 style)
+    int byteColumnCount = 0;
+    uint64_t timestampScaleNs = 1000000000ULL;  // nanoseconds per timestamp unit
+    int columnCount = 0;
+    const char *exporter = "generic";
+
+    bool isValid() const
+    {
+        return timestampColumn >= 0 && idColumn >= 0 && (dataColumn >= 0 || byteColumnCount > 0);
+    }
+};
+
+// Streaming reader for CAN CSV exports (SavvyCAN, PCAN-View, Kvaser and the
+// frame table's own column order). Works on a memory buffer like
+// CANLogParser, honours quoted fields and allocates nothing per record.
+class CANCSVParser {
+public:
+    static constexpr int kMaxFields = 96;
+
+    CANCSVParser(const char *begin, const char *end, const CSVSchema &schema);
+
+    // Fills frame with the next valid record. Returns false once the buffer is exhausted.
+    bool next(CANFrame &frame);
+
+    size_t bytesConsumed() const { return static_cast<size_t>(cursor - dataBegin); }
+    size_t bytesTotal() const { return static_cast<size_t>(dataEnd - dataBegin); }
+    size_t malformedLines() const { return malformed; }
+
+    // Detects the schema from the first line of a file. When the line holds
+    // data rather than column names, the frame table layout (timestamp, ID,
+    // data bytes, interface) is assumed and headerLines is set to 0.
+    static CSVSchema detectSchema(std::string_view firstLine, int &headerLines);
+
+private:
+    bool parseRecord(const std::string_view *fields, int count, CANFrame &frame);
+
+    const char *dataBegin;
+    const char *cursor;
+    const char *dataEnd;
+    CSVSchema schema;
+    size_t malformed = 0;
+    std::string_view fields[kMaxFields];
+    char interfaceBuffer[16];
+};
+
+#endif // CAN_CSV_PARSER_H
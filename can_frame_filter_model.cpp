@@ -0,0 +1,158 @@
+#include "can_frame_filter_model.h"
+
+#include <algorithm>
+#include <climits>
+
+CANFrameFilterModel::CANFrameFilterModel(QObject *parent)
+    : QAbstractProxyModel(parent)
+{
+}
+
+void CANFrameFilterModel::setSourceModel(QAbstractItemModel *model)
+{
+    beginResetModel();
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+    QAbstractProxyModel::setSourceModel(model);
+    visibleRows.clear();
+    filtered = false;
+    if (model) {
+        connect(model, &QAbstractItemModel::rowsAboutToBeInserted,
+                this, &CANFrameFilterModel::sourceRowsAboutToBeInserted);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &CANFrameFilterModel::sourceRowsInserted);
+        connect(model, &QAbstractItemModel::dataChanged, this, &CANFrameFilterModel::sourceDataChanged);
+        connect(model, &QAbstractItemModel::modelAboutToBeReset, this, &CANFrameFilterModel::sourceAboutToBeReset);
+        connect(model, &QAbstractItemModel::modelReset, this, &CANFrameFilterModel::sourceReset);
+    }
+    endResetModel();
+}
+
+void CANFrameFilterModel::setRows(std::vector<uint32_t> rows)
+{
+    beginResetModel();
+    visibleRows = std::move(rows);
+    filtered = true;
+    endResetModel();
+}
+
+void CANFrameFilterModel::appendRows(const std::vector<uint32_t> &rows)
+{
+    if (!filtered || rows.empty()) {
+        return;
+    }
+    int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(rows.size()) - 1);
+    visibleRows.insert(visibleRows.end(), rows.begin(), rows.end());
+    endInsertRows();
+}
+
+void CANFrameFilterModel::clearRows()
+{
+    beginResetModel();
+    visibleRows.clear();
+    visibleRows.shrink_to_fit();
+    filtered = false;
+    endResetModel();
+}
+
+QModelIndex CANFrameFilterModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || row < 0 || column < 0 || row >= rowCount() || column >= columnCount()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column);
+}
+
+QModelIndex CANFrameFilterModel::parent(const QModelIndex &) const
+{
+    return QModelIndex();
+}
+
+int CANFrameFilterModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !sourceModel()) {
+        return 0;
+    }
+    if (!filtered) {
+        return sourceModel()->rowCount();
+    }
+    return static_cast<int>(std::min<size_t>(visibleRows.size(), INT_MAX));
+}
+
+int CANFrameFilterModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !sourceModel()) {
+        return 0;
+    }
+    return sourceModel()->columnCount();
+}
+
+QModelIndex CANFrameFilterModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !sourceModel()) {
+        return QModelIndex();
+    }
+    int sourceRow = filtered ? static_cast<int>(visibleRows[proxyIndex.row()]) : proxyIndex.row();
+    return sourceModel()->index(sourceRow, proxyIndex.column());
+}
+
+QModelIndex CANFrameFilterModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid()) {
+        return QModelIndex();
+    }
+    if (!filtered) {
+        return index(sourceIndex.row(), sourceIndex.column());
+    }
+    uint32_t sourceRow = static_cast<uint32_t>(sourceIndex.row());
+    auto it = std::lower_bound(visibleRows.begin(), visibleRows.end(), sourceRow);
+    if (it == visibleRows.end() || *it != sourceRow) {
+        return QModelIndex();
+    }
+    return index(static_cast<int>(it - visibleRows.begin()), sourceIndex.column());
+}
+
+void CANFrameFilterModel::sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    // Filtered views are extended by their owner through appendRows()
+    if (!filtered) {
+        beginInsertRows(parent, first, last);
+    }
+}
+
+void CANFrameFilterModel::sourceRowsInserted()
+{
+    if (!filtered) {
+        endInsertRows();
+    }
+}
+
+void CANFrameFilterModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    // Map the changed source rows onto the shown rows they cover
+    int first = topLeft.row();
+    int last = bottomRight.row();
+    if (filtered) {
+        first = static_cast<int>(std::lower_bound(visibleRows.begin(), visibleRows.end(),
+                                                  static_cast<uint32_t>(topLeft.row())) - visibleRows.begin());
+        last = static_cast<int>(std::upper_bound(visibleRows.begin(), visibleRows.end(),
+                                                 static_cast<uint32_t>(bottomRight.row())) - visibleRows.begin()) - 1;
+    }
+    if (first <= last) {
+        emit dataChanged(index(first, topLeft.column()), index(last, bottomRight.column()));
+    }
+}
+
+void CANFrameFilterModel::sourceAboutToBeReset()
+{
+    beginResetModel();
+}
+
+void CANFrameFilterModel::sourceReset()
+{
+    // Row numbers in a filter no longer mean anything after a reset
+    visibleRows.clear();
+    filtered = false;
+    endResetModel();
+}
@@ -0,0 +1,51 @@
+#ifndef CAN_FRAME_FILTER_MODEL_H
+#define CAN_FRAME_FILTER_MODEL_H
+#pragma once
+
+#include <QAbstractProxyModel>
+#include <cstdint>
+#include <vector>
+
+// Proxy over CANFrameModel showing an ascending subset of its rows. Unlike
+// QSortFilterProxyModel it never asks the source about individual rows: the
+// caller hands over the row list (usually from CANIDIndex), so switching
+// filters costs the size of the result, not the size of the log. Without a
+// row list every source row passes through.
+class CANFrameFilterModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit CANFrameFilterModel(QObject *parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    // Shows only rows, which must be ascending source row numbers
+    void setRows(std::vector<uint32_t> rows);
+    // Adds rows to a filtered view; they must be ascending and come after
+    // every row shown so far. Does nothing while unfiltered.
+    void appendRows(const std::vector<uint32_t> &rows);
+    // Shows every source row again
+    void clearRows();
+    bool isFiltered() const { return filtered; }
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+
+private slots:
+    void sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsInserted();
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void sourceAboutToBeReset();
+    void sourceReset();
+
+private:
+    std::vector<uint32_t> visibleRows;
+    bool filtered = false;
+};
+
+#endif // CAN_FRAME_FILTER_MODEL_H
@@ -0,0 +1,133 @@
+#include "can_frame_model.h"
+#include "frame_format.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace {
+// Comfortably more rows than fit on a 4K screen
+constexpr int kRowCacheSize = 512;
+}
+
+CANFrameModel::CANFrameModel(const CANFrameStore *store, QObject *parent)
+    : QAbstractTableModel(parent)
+    , store(store)
+    , rowCache(kRowCacheSize)
+{
+}
+
+int CANFrameModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(std::min<size_t>(store->size(), INT_MAX));
+}
+
+int CANFrameModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant CANFrameModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole) {
+        return cachedRow(index.row()).cells[index.column()];
+    }
+    return QVariant();
+}
+
+QVariant CANFrameModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+
+    switch (section) {
+        case ColumnTimestamp: return QStringLiteral("Timestamp");
+        case ColumnID:        return QStringLiteral("CAN ID");
+        case ColumnData:      return QStringLiteral("Data Bytes");
+        case ColumnInterface: return QStringLiteral("Interface");
+        case ColumnMessage:   return QStringLiteral("Message");
+        case ColumnSignals:   return QStringLiteral("Signals");
+        default:              return QVariant();
+    }
+}
+
+void CANFrameModel::reload()
+{
+    beginResetModel();
+    invalidateRows();
+    endResetModel();
+}
+
+void CANFrameModel::beginAppend(int count)
+{
+    int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+}
+
+void CANFrameModel::endAppend()
+{
+    endInsertRows();
+}
+
+void CANFrameModel::setDatabase(const DBCDatabase *database)
+{
+    invalidateRows();
+    signalCache.setDatabase(database);
+    if (rowCount() > 0) {
+        emit dataChanged(index(0, ColumnMessage), index(rowCount() - 1, ColumnSignals));
+    }
+}
+
+void CANFrameModel::invalidateRows()
+{
+    for (CachedRow &cached : rowCache) {
+        cached.row = -1;
+    }
+    signalCache.clear();
+}
+
+const CANFrameModel::CachedRow &CANFrameModel::cachedRow(int row) const
+{
+    CachedRow &cached = rowCache[row % kRowCacheSize];
+    if (cached.row != row) {
+        uint8_t flags = store->flags(row);
+        cached.cells[ColumnTimestamp] = formatTimestamp(store->timestamp(row));
+        cached.cells[ColumnID] = formatCANID(store->id(row), flags);
+        cached.cells[ColumnData] = formatPayload(store->payload(row), store->dlc(row), flags);
+        cached.cells[ColumnInterface] = QString::fromStdString(store->interfaceName(row));
+
+        DecodedSignalCache::Row decoded = signalCache.row(*store, row);
+        cached.cells[ColumnMessage].clear();
+        cached.cells[ColumnSignals].clear();
+        if (decoded.decoder) {
+            cached.cells[ColumnMessage] = QString::fromStdString(decoded.decoder->name());
+            QString &text = cached.cells[ColumnSignals];
+            for (size_t i = 0; i < decoded.decoder->signalCount(); ++i) {
+                if (!decoded.present[i]) {
+                    continue;
+                }
+                const DBCSignal &signal = decoded.decoder->signal(i);
+                if (!text.isEmpty()) {
+                    text += QStringLiteral(", ");
+                }
+                text += QString::fromStdString(signal.name) + QLatin1Char('=')
+                      + QString::number(decoded.values[i], 'g', 10);
+                if (!signal.unit.empty()) {
+                    text += QLatin1Char(' ') + QString::fromStdString(signal.unit);
+                }
+            }
+        }
+        cached.row = row;
+    }
+    return cached;
+}
@@ -0,0 +1,67 @@
+#ifndef CAN_FRAME_MODEL_H
+#define CAN_FRAME_MODEL_H
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "frame_store.h"
+#include "decoded_signal_cache.h"
+
+// Read-only table model over a CANFrameStore. Cells are formatted lazily when
+// the view asks for them, and the formatted text of recently shown rows is
+// kept in a small direct-mapped cache sized for a screenful of rows. With a
+// DBC loaded the message and signal columns are decoded the same way, through
+// a DecodedSignalCache, so only rows that are drawn are ever decoded.
+class CANFrameModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColumnTimestamp,
+        ColumnID,
+        ColumnData,
+        ColumnInterface,
+        ColumnMessage,
+        ColumnSignals,
+        ColumnCount
+    };
+
+    explicit CANFrameModel(const CANFrameStore *store, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Call after the store was rebuilt from scratch
+    void reload();
+
+    // Bracket appending count frames to the store
+    void beginAppend(int count);
+    void endAppend();
+
+    // Loaded DBC messages, or null; see DecodedSignalCache
+    void setDatabase(const DBCDatabase *database);
+    bool hasDecoders() const { return signalCache.hasDecoders(); }
+    void setDecodeCacheBudget(size_t bytes) { signalCache.setBudget(bytes); }
+    size_t decodeCacheUsage() const { return signalCache.memoryUsage(); }
+
+private:
+    struct CachedRow {
+        int row = -1;
+        QString cells[ColumnCount];
+    };
+
+    const CachedRow &cachedRow(int row) const;
+    void invalidateRows();
+
+    const CANFrameStore *store;
+    mutable std::vector<CachedRow> rowCache;
+    mutable DecodedSignalCache signalCache;
+};
+
+#endif // CAN_FRAME_MODEL_H
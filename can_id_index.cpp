@@ -0,0 +1,111 @@
+#include "can_id_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+CANIDIndex::CANIDIndex()
+    : standardSlots(kStandardSlots, kNoPosting)
+{
+}
+
+void CANIDIndex::clear()
+{
+    std::fill(standardSlots.begin(), standardSlots.end(), kNoPosting);
+    extendedSlots.clear();
+    postingKeys.clear();
+    postings.clear();
+    rowsIndexed = 0;
+}
+
+uint32_t &CANIDIndex::slotOf(uint32_t key)
+{
+    if (key < kStandardSlots) {
+        return standardSlots[key];
+    }
+    return extendedSlots.try_emplace(key, kNoPosting).first->second;
+}
+
+uint32_t CANIDIndex::findSlot(uint32_t key) const
+{
+    if (key < kStandardSlots) {
+        return standardSlots[key];
+    }
+    auto it = extendedSlots.find(key);
+    return it == extendedSlots.end() ? kNoPosting : it->second;
+}
+
+void CANIDIndex::update(const CANFrameStore &store, std::vector<uint32_t> *newKeys)
+{
+    const FrameColumn<uint32_t> &ids = store.ids();
+    const FrameColumn<uint8_t> &flags = store.flagColumn();
+
+    // Logs repeat the same few IDs back to back often enough that remembering
+    // the last posting skips most slot lookups
+    uint32_t lastKey = kNoPosting;
+    std::vector<uint32_t> *lastRows = nullptr;
+    for (size_t row = rowsIndexed; row < ids.size(); ++row) {
+        uint32_t key = keyOf(ids[row], flags[row]);
+        if (key != lastKey) {
+            uint32_t &slot = slotOf(key);
+            if (slot == kNoPosting) {
+                slot = static_cast<uint32_t>(postings.size());
+                postings.emplace_back();
+                postingKeys.push_back(key);
+                if (newKeys) {
+                    newKeys->push_back(key);
+                }
+            }
+            lastKey = key;
+            lastRows = &postings[slot];
+        }
+        lastRows->push_back(static_cast<uint32_t>(row));
+    }
+    rowsIndexed = ids.size();
+}
+
+const std::vector<uint32_t> *CANIDIndex::rows(uint32_t key) const
+{
+    uint32_t slot = findSlot(key);
+    return slot == kNoPosting ? nullptr : &postings[slot];
+}
+
+std::vector<uint32_t> CANIDIndex::rowsOf(const std::vector<uint32_t> &keys) const
+{
+    std::vector<std::vector<uint32_t>> runs;
+    for (uint32_t key : keys) {
+        if (const std::vector<uint32_t> *keyRows = rows(key)) {
+            runs.push_back(*keyRows);
+        }
+    }
+    if (runs.empty()) {
+        return {};
+    }
+
+    // Pairwise merge rounds, n log k for k lists
+    while (runs.size() > 1) {
+        std::vector<std::vector<uint32_t>> merged;
+        merged.reserve((runs.size() + 1) / 2);
+        for (size_t i = 0; i + 1 < runs.size(); i += 2) {
+            std::vector<uint32_t> &out = merged.emplace_back();
+            out.reserve(runs[i].size() + runs[i + 1].size());
+            std::merge(runs[i].begin(), runs[i].end(), runs[i + 1].begin(), runs[i + 1].end(),
+                       std::back_inserter(out));
+        }
+        if (runs.size() % 2 != 0) {
+            merged.push_back(std::move(runs.back()));
+        }
+        runs.swap(merged);
+    }
+    return std::move(runs.front());
+}
+
+size_t CANIDIndex::memoryUsage() const
+{
+    size_t bytes = standardSlots.capacity() * sizeof(uint32_t)
+                 + postingKeys.capacity() * sizeof(uint32_t)
+                 + extendedSlots.size() * (sizeof(uint32_t) * 2 + sizeof(void *) * 2);
+    for (const std::vector<uint32_t> &posting : postings) {
+        bytes += posting.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,62 @@
+#ifndef CAN_ID_INDEX_H
+#define CAN_ID_INDEX_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "frame_store.h"
+
+// Posting lists over a CANFrameStore: for every CAN ID, the ascending row
+// numbers it occurs at. Built incrementally as frames are appended, so
+// selecting the rows of one ID costs a lookup instead of a scan of the log.
+// Standard IDs sit in a direct-mapped table, extended IDs in a hash map.
+class CANIDIndex
+{
+public:
+    // Keys tell standard and extended IDs apart, 0x123 and 0x00000123 are different IDs
+    static constexpr uint32_t kExtendedKeyBit = 0x80000000U;
+
+    static uint32_t keyOf(uint32_t id, uint8_t flags)
+    {
+        return id | ((flags & FrameExtended) ? kExtendedKeyBit : 0U);
+    }
+    static uint32_t idOf(uint32_t key) { return key & ~kExtendedKeyBit; }
+    static uint8_t flagsOf(uint32_t key) { return (key & kExtendedKeyBit) ? FrameExtended : 0; }
+
+    CANIDIndex();
+
+    void clear();
+
+    // Indexes the frames appended to store since the last call. Keys seen for
+    // the first time are added to newKeys, in order of first appearance.
+    void update(const CANFrameStore &store, std::vector<uint32_t> *newKeys = nullptr);
+
+    // Rows holding key, nullptr if it never occurred
+    const std::vector<uint32_t> *rows(uint32_t key) const;
+
+    // Ascending union of the rows of every key in keys
+    std::vector<uint32_t> rowsOf(const std::vector<uint32_t> &keys) const;
+
+    // Every key, in order of first appearance
+    const std::vector<uint32_t> &keys() const { return postingKeys; }
+
+    size_t indexedRows() const { return rowsIndexed; }
+    size_t memoryUsage() const;
+
+private:
+    static constexpr uint32_t kStandardSlots = 0x1000;  // three hex digits in a candump ID
+    static constexpr uint32_t kNoPosting = UINT32_MAX;
+
+    uint32_t &slotOf(uint32_t key);
+    uint32_t findSlot(uint32_t key) const;
+
+    std::vector<uint32_t> standardSlots;                // posting per standard ID, or kNoPosting
+    std::unordered_map<uint32_t, uint32_t> extendedSlots;
+    std::vector<uint32_t> postingKeys;
+    std::vector<std::vector<uint32_t>> postings;
+    size_t rowsIndexed = 0;
+};
+
+#endif // CAN_ID_INDEX_H
@@ -0,0 +1,306 @@
+#include "can_index_file.h"
+#include "mapped_file.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'A', 'N', 'V', 'I', 'D', 'X', '\0'};
+constexpr uint64_t kSectionAlignment = 64;
+constexpr qint64 kWriteBlock = 64 * 1024 * 1024;
+
+enum SectionId : uint32_t {
+    SectionTimestamps = 1,
+    SectionIDs,
+    SectionDLCs,
+    SectionFlags,
+    SectionInterfaces,
+    SectionPayloads,
+    SectionFDRows,
+    SectionFDPayloads,
+    SectionInterfaceNames,  // NUL-terminated names in index order
+    SectionCount = SectionInterfaceNames
+};
+
+// All fields little-endian, as written by the machines this runs on
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t frameCount;
+    int64_t sourceSize;
+    int64_t sourceModifiedMs;
+    uint64_t tableChecksum;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(FileHeader) == 64, "sidecar header must stay 64 bytes");
+
+struct SectionEntry {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+static_assert(sizeof(SectionEntry) == 32, "sidecar section entry must stay 32 bytes");
+
+// Four-lane multiply/rotate hash; runs at memory speed so checking a
+// multi-gigabyte sidecar stays well below the cost of parsing its log
+uint64_t checksum(const uint8_t *data, size_t size)
+{
+    constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+
+    uint64_t lanes[4] = {kPrime1, kPrime2, ~kPrime1, ~kPrime2};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, sizeof(word));
+            lanes[lane] = std::rotl(lanes[lane] + word * kPrime2, 31) * kPrime1;
+        }
+    }
+
+    uint64_t hash = static_cast<uint64_t>(size) * kPrime1;
+    for (int lane = 0; lane < 4; ++lane) {
+        hash = (hash ^ std::rotl(lanes[lane], lane * 7 + 1)) * kPrime2;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ data[i]) * kPrime1;
+    }
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+struct SectionData {
+    SectionId id;
+    const uint8_t *data;
+    uint64_t size;
+};
+
+template <typename Column>
+SectionData section(SectionId id, const Column &column)
+{
+    return {id, reinterpret_cast<const uint8_t *>(column.data()), column.size() * sizeof(*column.data())};
+}
+
+uint64_t alignUp(uint64_t value)
+{
+    return (value + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+// Points column at its section of the mapping instead of copying it out
+template <typename T>
+bool borrowColumn(const SectionEntry &entry, const std::shared_ptr<MappedFile> &file, uint64_t expectedCount,
+                  FrameColumn<T> &column)
+{
+    if (entry.size != expectedCount * sizeof(T) || entry.offset % alignof(T) != 0) {
+        return false;
+    }
+    column.borrow(reinterpret_cast<const T *>(file->begin() + entry.offset), expectedCount, file);
+    return true;
+}
+
+} // namespace
+
+QString CANIndexFile::sidecarPath(const QString &logPath)
+{
+    return logPath + ".canidx";
+}
+
+CANIndexFile::SourceKey CANIndexFile::sourceKey(const QString &logPath)
+{
+    QFileInfo info(logPath);
+    SourceKey key;
+    if (info.exists()) {
+        key.size = info.size();
+        key.modifiedMs = info.lastModified().toMSecsSinceEpoch();
+    }
+    return key;
+}
+
+bool CANIndexFile::load(const QString &logPath, CANFrameStore &store)
+{
+    store.clear();
+
+    SourceKey key = sourceKey(logPath);
+    auto file = std::make_shared<MappedFile>();
+    if (key.size < 0 || !file->open(sidecarPath(logPath))) {
+        return false;
+    }
+
+    uint64_t fileSize = static_cast<uint64_t>(file->size());
+    if (fileSize < sizeof(FileHeader)) {
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(&header, file->begin(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || header.sectionCount != SectionCount
+        || header.sourceSize != key.size || header.sourceModifiedMs != key.modifiedMs) {
+        return false;
+    }
+
+    uint64_t tableSize = header.sectionCount * sizeof(SectionEntry);
+    if (fileSize < sizeof(FileHeader) + tableSize) {
+        return false;
+    }
+    const uint8_t *tableData = reinterpret_cast<const uint8_t *>(file->begin()) + sizeof(FileHeader);
+    if (checksum(tableData, tableSize) != header.tableChecksum) {
+        return false;
+    }
+
+    SectionEntry entries[SectionCount];
+    std::memcpy(entries, tableData, tableSize);
+    for (uint32_t i = 0; i < SectionCount; ++i) {
+        const SectionEntry &entry = entries[i];
+        if (entry.id != i + 1 || entry.offset > fileSize || entry.size > fileSize - entry.offset) {
+            return false;
+        }
+    }
+
+    // The columns are used in place and only page in as they are read, so
+    // their checksums are not verified here: that pass would read the whole
+    // file up front. Sidecars are replaced atomically and keyed to their log;
+    // what the store indexes with (names, interface indices, DLCs and the FD
+    // side table) is checked.
+    const SectionEntry &namesEntry = entries[SectionInterfaceNames - 1];
+    const char *names = file->begin() + namesEntry.offset;
+    const char *namesEnd = names + namesEntry.size;
+    if (checksum(reinterpret_cast<const uint8_t *>(names), namesEntry.size) != namesEntry.checksum) {
+        return false;
+    }
+    while (names < namesEnd) {
+        const char *nul = static_cast<const char *>(std::memchr(names, '\0', namesEnd - names));
+        if (!nul || store.interfaces.size() >= CANFrameStore::kMaxInterfaces) {
+            store.clear();
+            return false;
+        }
+        store.interfaces.emplace_back(names, nul);
+        names = nul + 1;
+    }
+
+    uint64_t frames = header.frameCount;
+    const SectionEntry &fdRowsEntry = entries[SectionFDRows - 1];
+    uint64_t fdFrames = fdRowsEntry.size / sizeof(uint64_t);
+    bool ok = borrowColumn(entries[SectionTimestamps - 1], file, frames, store.timestampColumn)
+           && borrowColumn(entries[SectionIDs - 1], file, frames, store.idColumn)
+           && borrowColumn(entries[SectionDLCs - 1], file, frames, store.dlcColumn)
+           && borrowColumn(entries[SectionFlags - 1], file, frames, store.flagsColumn)
+           && borrowColumn(entries[SectionInterfaces - 1], file, frames, store.interfaceColumn)
+           && borrowColumn(entries[SectionPayloads - 1], file, frames * CANFrameStore::kPayloadStride, store.payloadColumn)
+           && borrowColumn(fdRowsEntry, file, fdFrames, store.fdRows)
+           && borrowColumn(entries[SectionFDPayloads - 1], file, fdFrames * 64, store.fdPayloads);
+
+    if (ok) {
+        uint8_t highestInterface = 0;
+        for (uint8_t index : store.interfaceColumn) {
+            highestInterface = std::max(highestInterface, index);
+        }
+        ok = frames == 0 || highestInterface < store.interfaces.size();
+    }
+
+    // payload() goes to the FD side table for every row with more than 8
+    // bytes, so the table must list exactly those rows, in order
+    if (ok) {
+        uint64_t longFrames = 0;
+        for (uint8_t dlc : store.dlcColumn) {
+            ok = ok && dlc <= 64;
+            longFrames += dlc > CANFrameStore::kPayloadStride;
+        }
+        ok = ok && longFrames == fdFrames;
+    }
+    for (size_t i = 0; ok && i < store.fdRows.size(); ++i) {
+        uint64_t row = store.fdRows[i];
+        ok = row < frames && (i == 0 || row > store.fdRows[i - 1])
+          && store.dlcColumn[row] > CANFrameStore::kPayloadStride;
+    }
+
+    if (!ok) {
+        store.clear();
+    }
+    return ok;
+}
+
+bool CANIndexFile::save(const QString &logPath, const CANFrameStore &store, const std::atomic<bool> &cancel)
+{
+    SourceKey key = sourceKey(logPath);
+    if (key.size < 0) {
+        return false;
+    }
+
+    std::vector<char> names;
+    for (const std::string &name : store.interfaces) {
+        names.insert(names.end(), name.begin(), name.end());
+        names.push_back('\0');
+    }
+
+    SectionData sections[SectionCount] = {
+        section(SectionTimestamps, store.timestampColumn),
+        section(SectionIDs, store.idColumn),
+        section(SectionDLCs, store.dlcColumn),
+        section(SectionFlags, store.flagsColumn),
+        section(SectionInterfaces, store.interfaceColumn),
+        section(SectionPayloads, store.payloadColumn),
+        section(SectionFDRows, store.fdRows),
+        section(SectionFDPayloads, store.fdPayloads),
+        section(SectionInterfaceNames, names),
+    };
+
+    SectionEntry entries[SectionCount];
+    uint64_t offset = alignUp(sizeof(FileHeader) + sizeof(entries));
+    for (int i = 0; i < SectionCount; ++i) {
+        if (cancel) {
+            return false;
+        }
+        entries[i] = {sections[i].id, 0, offset, sections[i].size, checksum(sections[i].data, sections[i].size)};
+        offset = alignUp(offset + sections[i].size);
+    }
+
+    FileHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.sectionCount = SectionCount;
+    header.frameCount = store.size();
+    header.sourceSize = key.size;
+    header.sourceModifiedMs = key.modifiedMs;
+    header.tableChecksum = checksum(reinterpret_cast<const uint8_t *>(entries), sizeof(entries));
+
+    QSaveFile file(sidecarPath(logPath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries), sizeof(entries));
+
+    static const char padding[kSectionAlignment] = {};
+    for (int i = 0; i < SectionCount; ++i) {
+        file.write(padding, static_cast<qint64>(entries[i].offset) - file.pos());
+        const char *data = reinterpret_cast<const char *>(sections[i].data);
+        qint64 remaining = static_cast<qint64>(sections[i].size);
+        while (remaining > 0) {
+            if (cancel) {
+                file.cancelWriting();
+                return false;
+            }
+            qint64 written = file.write(data, std::min(remaining, kWriteBlock));
+            if (written <= 0) {
+                file.cancelWriting();
+                return false;
+            }
+            data += written;
+            remaining -= written;
+        }
+    }
+    return file.commit();
+}
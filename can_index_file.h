@@ -0,0 +1,46 @@
+#ifndef CAN_INDEX_FILE_H
+#define CAN_INDEX_FILE_H
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include "frame_store.h"
+
+// Binary sidecar (<log>.canidx) holding a parsed log's frame store, so a log
+// that was opened before loads without a re-parse. The loaded store's columns
+// point straight into the mapped file; only appending to it copies them.
+//
+// Layout: a fixed header, a section table, then one 64-byte aligned section
+// per column. Every section carries a checksum and the header records the
+// source file's size and modification time; a sidecar whose key does not
+// match its log is stale and ignored. Load verifies the table and the small
+// sections but not the bulk columns, which would mean reading every page.
+//
+// Only the frames are stored. The time, ID and bus state indexes and the bus
+// statistics are rebuilt from them on open, which costs far less than the
+// parse the sidecar saves.
+class CANIndexFile
+{
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    // Identifies the log a sidecar was built from
+    struct SourceKey {
+        qint64 size = -1;
+        qint64 modifiedMs = 0;
+    };
+
+    static QString sidecarPath(const QString &logPath);
+    static SourceKey sourceKey(const QString &logPath);
+
+    // Fills store from the sidecar of logPath. Returns false, leaving store
+    // empty, when there is no sidecar or it is stale, truncated or corrupt.
+    static bool load(const QString &logPath, CANFrameStore &store);
+
+    // Writes store as the sidecar of logPath, replacing any old one atomically.
+    // Gives up without leaving a file behind once cancel becomes true.
+    static bool save(const QString &logPath, const CANFrameStore &store, const std::atomic<bool> &cancel);
+};
+
+#endif // CAN_INDEX_FILE_H
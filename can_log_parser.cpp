@@ -0,0 +1,155 @@
+#include "can_log_parser.h"
+#include "hex_decode.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t kHexInvalid = 0xFF;
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+constexpr uint32_t kErrFlag = 0x20000000U;  // CAN_ERR_FLAG
+constexpr uint32_t kIdMask  = 0x1FFFFFFFU;  // CAN_EFF_MASK
+
+} // namespace
+
+CANLogParser::CANLogParser(const char *begin, const char *end)
+    : dataBegin(begin)
+    , cursor(begin)
+    , dataEnd(end)
+{
+}
+
+bool CANLogParser::next(CANFrame &frame)
+{
+    while (cursor < dataEnd) {
+        const char *line = cursor;
+        const char *eol = static_cast<const char *>(std::memchr(line, '\n', dataEnd - line));
+        if (!eol) {
+            eol = dataEnd;
+            cursor = dataEnd;
+        } else {
+            cursor = eol + 1;
+        }
+
+        if (parseLine(line, eol, frame)) {
+            return true;
+        }
+
+        // Blank lines are not worth reporting as malformed
+        const char *p = line;
+        while (p < eol && isSpace(*p)) ++p;
+        if (p < eol) ++malformed;
+    }
+    return false;
+}
+
+bool CANLogParser::parseLine(const char *p, const char *eol, CANFrame &frame)
+{
+    // State 1: "(" seconds "." fraction ")"
+    while (p < eol && isSpace(*p)) ++p;
+    if (p >= eol || *p != '(') return false;
+    ++p;
+
+    uint64_t seconds = 0;
+    const char *digits = p;
+    while (p < eol && isDigit(*p)) seconds = seconds * 10 + static_cast<uint64_t>(*p++ - '0');
+    if (p == digits) return false;
+
+    uint64_t fraction = 0;
+    int fractionDigits = 0;
+    if (p < eol && *p == '.') {
+        ++p;
+        while (p < eol && isDigit(*p)) {
+            // Anything past nanosecond resolution is dropped
+            if (fractionDigits < 9) {
+                fraction = fraction * 10 + static_cast<uint64_t>(*p - '0');
+                ++fractionDigits;
+            }
+            ++p;
+        }
+    }
+    if (p >= eol || *p != ')') return false;
+    ++p;
+    for (int i = fractionDigits; i < 9; ++i) fraction *= 10;
+    frame.timestampNs = seconds * 1000000000ULL + fraction;
+
+    // State 2: interface name
+    while (p < eol && isSpace(*p)) ++p;
+    const char *iface = p;
+    while (p < eol && !isSpace(*p)) ++p;
+    if (p == iface) return false;
+    frame.interfaceName = std::string_view(iface, static_cast<size_t>(p - iface));
+
+    // State 3: hexadecimal ID up to '#'
+    while (p < eol && isSpace(*p)) ++p;
+    const char *idStart = p;
+    uint32_t id = 0;
+    while (p < eol && *p != '#') {
+        uint8_t v = hexDigitValue(*p);
+        if (v == kHexInvalid) return false;
+        id = (id << 4) | v;
+        ++p;
+    }
+    size_t idLength = static_cast<size_t>(p - idStart);
+    if (idLength == 0 || idLength > 8 || p >= eol) return false;
+    ++p;  // '#'
+
+    frame.flags = 0;
+    if (idLength > 3) {
+        if (id & kErrFlag) frame.flags |= FrameError;
+        frame.flags |= FrameExtended;
+        id &= kIdMask;
+    }
+    frame.id = id;
+
+    // State 4: payload. "##" introduces an FD frame with a leading flags nibble,
+    // "R" a remote request with an optional length digit.
+    size_t maxLength = 8;
+    if (p < eol && *p == '#') {
+        ++p;
+        if (p >= eol) return false;
+        uint8_t fdFlags = hexDigitValue(*p++);
+        if (fdFlags == kHexInvalid) return false;
+        frame.flags |= FrameFD;
+        if (fdFlags & 0x1) frame.flags |= FrameBRS;
+        if (fdFlags & 0x2) frame.flags |= FrameESI;
+        maxLength = 64;
+    } else if (p < eol && (*p == 'R' || *p == 'r')) {
+        ++p;
+        frame.flags |= FrameRemote;
+        frame.dlc = 0;
+        if (p < eol && isDigit(*p)) frame.dlc = static_cast<uint8_t>(*p - '0');
+        return true;
+    }
+
+    // Payload bytes go through the vectorized kernel; it stops at the end of
+    // the hex run, which is the end of the line or an optional '.' separator
+    size_t length = 0;
+    for (;;) {
+        size_t decoded = decodeHexRun(p, eol, frame.data + length, maxLength - length);
+        length += decoded;
+        p += decoded * 2;
+        if (p < eol && *p == '.' && length < maxLength) {
+            ++p;
+            continue;
+        }
+        break;
+    }
+    frame.dlc = static_cast<uint8_t>(length);
+
+    // Trailing "_L" raw DLC suffix, whitespace or direction markers are ignored,
+    // but a hex digit or '.' here is either a truncated byte or a payload that
+    // is too long.
+    if (p < eol && (*p == '.' || hexDigitValue(*p) != kHexInvalid)) return false;
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef CAN_LOG_PARSER_H
+#define CAN_LOG_PARSER_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Flag bits carried alongside every parsed frame
+enum CANFrameFlags : uint8_t {
+    FrameExtended = 0x01,  // 29-bit identifier
+    FrameRemote   = 0x02,  // RTR frame, no payload
+    FrameFD       = 0x04,  // CAN FD frame ("##" form)
+    FrameBRS      = 0x08,  // FD bit rate switch
+    FrameESI      = 0x10,  // FD error state indicator
+    FrameError    = 0x20,  // error frame (CAN_ERR_FLAG set in the ID)
+};
+
+// One typed candump frame. Lives on the caller's stack; interfaceName points
+// into the parsed buffer and is only valid while that buffer is.
+struct CANFrame {
+    uint64_t timestampNs = 0;
+    uint32_t id = 0;
+    uint8_t dlc = 0;       // payload length in bytes (0..64), requested length for RTR
+    uint8_t flags = 0;     // CANFrameFlags
+    uint8_t data[64];
+    std::string_view interfaceName;
+};
+
+// Scans SocketCAN candump text ("(timestamp) iface ID#DATA") straight out of a
+// memory buffer. No allocation happens per line; malformed lines are skipped
+// and counted.
+class CANLogParser {
+public:
+    CANLogParser(const char *begin, const char *end);
+
+    // Fills frame with the next valid line. Returns false once the buffer is exhausted.
+    bool next(CANFrame &frame);
+
+    size_t bytesConsumed() const { return static_cast<size_t>(cursor - dataBegin); }
+    size_t bytesTotal() const { return static_cast<size_t>(dataEnd - dataBegin); }
+    size_t malformedLines() const { return malformed; }
+
+    // Parses a single line (without its newline). Exposed for other readers.
+    static bool parseLine(const char *line, const char *eol, CANFrame &frame);
+
+private:
+    const char *dataBegin;
+    const char *cursor;
+    const char *dataEnd;
+    size_t malformed = 0;
+};
+
+#endif // CAN_LOG_PARSER_H
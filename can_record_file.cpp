@@ -0,0 +1,108 @@
+#include "can_record_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr char kMagic[8] = {'C', 'A', 'N', 'V', 'R', 'E', 'C', '\0'};
+}
+
+size_t CANRecordFile::writeHeader(uint8_t *out)
+{
+    uint32_t version = kVersion;
+    std::memset(out, 0, kHeaderBytes);
+    std::memcpy(out, kMagic, sizeof(kMagic));
+    std::memcpy(out + sizeof(kMagic), &version, sizeof(version));
+    return kHeaderBytes;
+}
+
+size_t CANRecordFile::writeInterface(uint8_t *out, uint8_t index, std::string_view name)
+{
+    size_t length = std::min<size_t>(name.size(), UINT8_MAX);
+    out[0] = RecordInterface;
+    out[1] = index;
+    out[2] = static_cast<uint8_t>(length);
+    std::memcpy(out + 3, name.data(), length);
+    return 3 + length;
+}
+
+size_t CANRecordFile::writeFrame(uint8_t *out, const CANFrameStore &store, size_t row, uint8_t interfaceIndex)
+{
+    uint64_t timestamp = store.timestamp(row);
+    uint32_t id = store.id(row);
+    uint8_t dlc = store.dlc(row);
+    uint8_t flags = store.flags(row);
+    size_t payloadLength = (flags & FrameRemote) ? 0 : dlc;  // remote frames keep the DLC only
+    out[0] = RecordFrame;
+    std::memcpy(out + 1, &timestamp, sizeof(timestamp));
+    std::memcpy(out + 9, &id, sizeof(id));
+    out[13] = dlc;
+    out[14] = flags;
+    out[15] = interfaceIndex;
+    std::memcpy(out + kFrameHeaderBytes, store.payload(row), payloadLength);
+    return kFrameHeaderBytes + payloadLength;
+}
+
+bool CANRecordFile::hasHeader(const char *begin, const char *end)
+{
+    uint32_t version = 0;
+    if (end - begin < static_cast<ptrdiff_t>(kHeaderBytes) || std::memcmp(begin, kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    std::memcpy(&version, begin + sizeof(kMagic), sizeof(version));
+    return version == kVersion;
+}
+
+CANRecordParser::CANRecordParser(const char *begin, const char *end)
+    : dataBegin(begin)
+    , cursor(begin)
+    , dataEnd(end)
+{
+    if (CANRecordFile::hasHeader(begin, end)) {
+        cursor += CANRecordFile::kHeaderBytes;
+    } else {
+        cursor = end;
+        malformed = begin == end ? 0 : 1;
+    }
+}
+
+bool CANRecordParser::next(CANFrame &frame)
+{
+    while (cursor < dataEnd) {
+        size_t left = static_cast<size_t>(dataEnd - cursor);
+        const uint8_t *record = reinterpret_cast<const uint8_t *>(cursor);
+
+        if (record[0] == CANRecordFile::RecordInterface) {
+            if (left < 3 || left < 3u + record[2]) {
+                break;
+            }
+            interfaceNames[record[1]].assign(cursor + 3, record[2]);
+            cursor += 3 + record[2];
+            continue;
+        }
+
+        if (record[0] != CANRecordFile::RecordFrame || left < CANRecordFile::kFrameHeaderBytes) {
+            break;
+        }
+        uint8_t dlc = record[13];
+        size_t payloadLength = (record[14] & FrameRemote) ? 0 : dlc;
+        if (dlc > sizeof(frame.data) || left < CANRecordFile::kFrameHeaderBytes + payloadLength) {
+            break;
+        }
+        std::memcpy(&frame.timestampNs, record + 1, sizeof(frame.timestampNs));
+        std::memcpy(&frame.id, record + 9, sizeof(frame.id));
+        frame.dlc = dlc;
+        frame.flags = record[14];
+        frame.interfaceName = interfaceNames[record[15]];
+        std::memcpy(frame.data, record + CANRecordFile::kFrameHeaderBytes, payloadLength);
+        cursor += CANRecordFile::kFrameHeaderBytes + payloadLength;
+        return true;
+    }
+
+    // Records cannot be resynchronised after a bad one, the rest is lost
+    if (cursor < dataEnd) {
+        ++malformed;
+        cursor = dataEnd;
+    }
+    return false;
+}
@@ -0,0 +1,68 @@
+#ifndef CAN_RECORD_FILE_H
+#define CAN_RECORD_FILE_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "can_log_parser.h"
+#include "frame_store.h"
+
+// Compact binary recording (.canrec), written as frames stream in and read
+// back front to back. A 16-byte header (magic, version) is followed by
+// records, each starting with a kind byte:
+//
+//   RecordInterface: index u8, name length u8, name
+//   RecordFrame:     timestamp ns u64, ID u32, DLC u8, CANFrameFlags u8,
+//                    interface index u8, DLC payload bytes
+//
+// An interface record precedes the first frame that uses its index. All
+// fields are little-endian; a classic 8-byte frame takes 24 bytes.
+class CANRecordFile
+{
+public:
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kHeaderBytes = 16;
+    static constexpr size_t kFrameHeaderBytes = 16;
+    static constexpr size_t kMaxFrameBytes = kFrameHeaderBytes + 64;
+    static constexpr size_t kMaxInterfaceBytes = 3 + UINT8_MAX;
+
+    enum RecordKind : uint8_t {
+        RecordFrame = 0,
+        RecordInterface = 1
+    };
+
+    // Each writes at out, which must have room for the record, and returns
+    // the number of bytes written
+    static size_t writeHeader(uint8_t *out);
+    static size_t writeInterface(uint8_t *out, uint8_t index, std::string_view name);
+    static size_t writeFrame(uint8_t *out, const CANFrameStore &store, size_t row, uint8_t interfaceIndex);
+
+    static bool hasHeader(const char *begin, const char *end);
+};
+
+// Reads the records of a .canrec file out of a memory buffer, the whole file
+// including its header. A truncated or unknown record ends the file and is
+// counted as malformed.
+class CANRecordParser {
+public:
+    CANRecordParser(const char *begin, const char *end);
+
+    // Fills frame with the next frame record. Returns false once the buffer is
+    // exhausted. frame.interfaceName stays valid as long as the parser.
+    bool next(CANFrame &frame);
+
+    size_t bytesConsumed() const { return static_cast<size_t>(cursor - dataBegin); }
+    size_t bytesTotal() const { return static_cast<size_t>(dataEnd - dataBegin); }
+    size_t malformedRecords() const { return malformed; }
+
+private:
+    const char *dataBegin;
+    const char *cursor;
+    const char *dataEnd;
+    size_t malformed = 0;
+    std::string interfaceNames[UINT8_MAX + 1];
+};
+
+#endif // CAN_RECORD_FILE_H
@@ -0,0 +1,143 @@
+#include "dbc_database.h"
+#include "dbc_handler.h"
+#include "mapped_file.h"
+#include "libs/can-utils/dbc/dbc_parser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+DBCDatabase::DBCDatabase()
+{
+    clear();
+}
+
+void DBCDatabase::clear()
+{
+    buses.assign(1, std::string());
+    decoders.clear();
+    messageKeys.clear();
+    messageBuses.clear();
+    slots.clear();
+    slotShift = 64;
+    interfaceBuses.clear();
+}
+
+bool DBCDatabase::load(const std::vector<DBCSource> &sources, int threads)
+{
+    clear();
+    error.clear();
+
+    // Each file is parsed straight out of its mapping into its own handler
+    std::vector<DBCHandler> handlers(sources.size());
+    std::vector<QString> errors(sources.size());
+    std::atomic<size_t> nextSource{0};
+    auto work = [&]() {
+        for (size_t i = nextSource++; i < sources.size(); i = nextSource++) {
+            MappedFile file;
+            if (!file.open(sources[i].filePath)) {
+                errors[i] = QString("Unable to open %1: %2").arg(sources[i].filePath, file.errorString());
+                continue;
+            }
+            std::string_view text(file.begin(), static_cast<size_t>(file.size()));
+            if (!can::parse_dbc(text, std::ref(handlers[i]))) {
+                errors[i] = QString("Failed to parse %1").arg(sources[i].filePath);
+            }
+        }
+    };
+
+    size_t workers = threads > 0 ? static_cast<size_t>(threads)
+                                 : std::max<size_t>(1, std::thread::hardware_concurrency());
+    workers = std::max<size_t>(1, std::min(workers, sources.size()));
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t w = 1; w < workers; ++w) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    for (const QString &message : errors) {
+        if (!message.isEmpty()) {
+            error = message;
+            clear();
+            return false;
+        }
+    }
+
+    // Merged in file order; a later file redefining a message on the same
+    // bus replaces the earlier definition
+    std::unordered_map<uint64_t, uint32_t> merged;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        uint32_t bus = busIndex(sources[i].interfaceName);
+        for (const auto &[id, definition] : handlers[i].definitions) {
+            auto [it, added] = merged.try_emplace(slotKey(bus, id), static_cast<uint32_t>(decoders.size()));
+            if (added) {
+                decoders.emplace_back(definition);
+                messageKeys.push_back(id);
+                messageBuses.push_back(bus);
+            } else {
+                decoders[it->second] = MessageDecoder(definition);
+            }
+        }
+    }
+    buildSlots();
+    return true;
+}
+
+uint32_t DBCDatabase::busIndex(const std::string &interfaceName)
+{
+    if (interfaceName.empty()) {
+        return kAnyBus;
+    }
+    auto it = std::find(buses.begin() + 1, buses.end(), interfaceName);
+    if (it != buses.end()) {
+        return static_cast<uint32_t>(it - buses.begin());
+    }
+    buses.push_back(interfaceName);
+    return static_cast<uint32_t>(buses.size() - 1);
+}
+
+void DBCDatabase::buildSlots()
+{
+    // At most half full keeps linear probe runs short
+    size_t capacity = 16;
+    unsigned bits = 4;
+    while (capacity < decoders.size() * 2) {
+        capacity *= 2;
+        ++bits;
+    }
+    slots.assign(capacity, Slot());
+    slotShift = 64 - bits;
+    for (size_t i = 0; i < decoders.size(); ++i) {
+        insert(messageBuses[i], messageKeys[i], static_cast<uint32_t>(i));
+    }
+}
+
+void DBCDatabase::insert(uint32_t bus, uint32_t key, uint32_t message)
+{
+    uint64_t wanted = slotKey(bus, key);
+    size_t mask = slots.size() - 1;
+    size_t i = slotOf(wanted);
+    while (slots[i].message != kEmptySlot && slots[i].key != wanted) {
+        i = (i + 1) & mask;
+    }
+    slots[i].key = wanted;
+    slots[i].message = message;
+}
+
+void DBCDatabase::bindInterfaces(const std::vector<std::string> &interfaceNames)
+{
+    interfaceBuses.assign(interfaceNames.size(), kAnyBus);
+    for (size_t i = 0; i < interfaceNames.size(); ++i) {
+        auto it = std::find(buses.begin() + 1, buses.end(), interfaceNames[i]);
+        if (it != buses.end()) {
+            interfaceBuses[i] = static_cast<uint32_t>(it - buses.begin());
+        }
+    }
+}
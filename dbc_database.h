@@ -0,0 +1,105 @@
+#ifndef DBC_DATABASE_H
+#define DBC_DATABASE_H
+#pragma once
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "signal_decoder.h"
+
+// One DBC file and the interface (bus) it describes; an empty interface
+// name applies the file to every interface
+struct DBCSource {
+    QString filePath;
+    std::string interfaceName;
+};
+
+// Compiled messages of any number of DBC files. Files are memory mapped and
+// parsed in place, one thread per file, then merged into a flat
+// open-addressing table keyed on (bus, CANIDIndex key), so the per-frame
+// lookup is a multiply, a shift and usually one probe.
+class DBCDatabase
+{
+public:
+    DBCDatabase();
+
+    // Replaces the contents with sources; on failure the database is left
+    // empty and errorString() names the file. threads <= 0 uses every core.
+    bool load(const std::vector<DBCSource> &sources, int threads = 0);
+    const QString &errorString() const { return error; }
+
+    void clear();
+    bool empty() const { return decoders.empty(); }
+
+    size_t messageCount() const { return decoders.size(); }
+    const MessageDecoder &message(size_t index) const { return decoders[index]; }
+    uint32_t messageKey(size_t index) const { return messageKeys[index]; }
+    // Interface the message's DBC was loaded for, empty for every interface
+    const std::string &messageInterface(size_t index) const { return buses[messageBuses[index]]; }
+
+    // Maps store interface indices onto the loaded buses; call again when
+    // the store learns new interface names
+    void bindInterfaces(const std::vector<std::string> &interfaceNames);
+
+    // Decoder for key on the given store interface: the DBC of that bus if
+    // it has the message, else a DBC loaded for every interface
+    const MessageDecoder *find(uint32_t key, uint8_t interfaceIndex) const
+    {
+        if (interfaceIndex < interfaceBuses.size() && interfaceBuses[interfaceIndex] != kAnyBus) {
+            if (const MessageDecoder *decoder = findOnBus(interfaceBuses[interfaceIndex], key)) {
+                return decoder;
+            }
+        }
+        return findOnBus(kAnyBus, key);
+    }
+
+private:
+    static constexpr uint32_t kAnyBus = 0;
+    static constexpr uint32_t kEmptySlot = UINT32_MAX;
+
+    struct Slot {
+        uint64_t key = 0;  // bus << 32 | CANIDIndex key
+        uint32_t message = kEmptySlot;
+    };
+
+    static uint64_t slotKey(uint32_t bus, uint32_t key) { return (static_cast<uint64_t>(bus) << 32) | key; }
+    size_t slotOf(uint64_t key) const
+    {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> slotShift);
+    }
+
+    const MessageDecoder *findOnBus(uint32_t bus, uint32_t key) const
+    {
+        if (slots.empty()) {
+            return nullptr;
+        }
+        uint64_t wanted = slotKey(bus, key);
+        size_t mask = slots.size() - 1;
+        for (size_t i = slotOf(wanted);; i = (i + 1) & mask) {
+            const Slot &slot = slots[i];
+            if (slot.message == kEmptySlot) {
+                return nullptr;
+            }
+            if (slot.key == wanted) {
+                return &decoders[slot.message];
+            }
+        }
+    }
+
+    uint32_t busIndex(const std::string &interfaceName);
+    void insert(uint32_t bus, uint32_t key, uint32_t message);
+    void buildSlots();
+
+    std::vector<std::string> buses;  // buses[kAnyBus] is the empty name
+    std::vector<MessageDecoder> decoders;
+    std::vector<uint32_t> messageKeys;
+    std::vector<uint32_t> messageBuses;
+    std::vector<Slot> slots;  // power of two, at most half full
+    unsigned slotShift = 64;
+    std::vector<uint32_t> interfaceBuses;  // store interface index -> bus
+    QString error;
+};
+
+#endif // DBC_DATABASE_H
@@ -6,30 +6,110 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <optional>
 #include <utility>
 #include "libs/can-utils/dbc/dbc_parser.h"
 
+// One SG_ line of a DBC file
+struct DBCSignal {
+    enum class Multiplex {
+        None,         // always present
+        Multiplexor,  // the switch selecting which multiplexed signals are present
+        Multiplexed   // present when the multiplexor equals multiplexValue
+    };
+
+    std::string name;
+    unsigned startBit = 0;     // LSB for Intel signals, MSB (sawtooth numbering) for Motorola
+    unsigned length = 0;
+    bool bigEndian = false;    // Motorola byte order
+    bool isSigned = false;
+    double factor = 1.0;
+    double offset = 0.0;
+    double minimum = 0.0;
+    double maximum = 0.0;
+    std::string unit;
+    Multiplex multiplex = Multiplex::None;
+    unsigned multiplexValue = 0;
+};
+
+// One BO_ block; the ID has bit 31 set for extended frames, as in the DBC
+struct DBCMessage {
+    uint32_t id = 0;
+    std::string name;
+    size_t size = 0;
+    std::vector<DBCSignal> messageSignals;
+};
+
 struct DBCHandler {
     std::map<std::string, std::vector<std::pair<unsigned, std::string>>> valTables;
     std::map<uint32_t, std::string> messages;  // ID → name
+    std::map<uint32_t, DBCMessage> definitions;  // ID → message with its signals
 
 };
 
 namespace can {
-    void tag_invoke(
+    inline void tag_invoke(
         def_val_table_cpo, DBCHandler &this_,
         std::string table_name, std::vector<std::pair<unsigned, std::string>> val_descs
     ) {
         this_.valTables[table_name] = val_descs;
     }
 
-    void tag_invoke(
+    inline void tag_invoke(
         def_bo_cpo, DBCHandler &this_,
         uint32_t msg_id, std::string msg_name,
         size_t msg_size, size_t /* transmitter_ord */
     ) {
         this_.messages[msg_id] = msg_name;
+        DBCMessage &message = this_.definitions[msg_id];
+        message.id = msg_id;
+        message.name = msg_name;
+        message.size = msg_size;
+    }
+
+    // byte_order is '0' for Motorola and '1' for Intel, sign_type '+' or '-'
+    inline void tag_invoke(
+        def_sg_cpo, DBCHandler &this_,
+        uint32_t msg_id, std::optional<unsigned> mux_val, std::string sig_name,
+        unsigned start_bit, unsigned sig_size, char byte_order, char sign_type,
+        double factor, double offset, double min_val, double max_val,
+        std::string unit, std::vector<size_t> /* receivers */
+    ) {
+        DBCSignal signal;
+        signal.name = std::move(sig_name);
+        signal.startBit = start_bit;
+        signal.length = sig_size;
+        signal.bigEndian = byte_order == '0';
+        signal.isSigned = sign_type == '-';
+        signal.factor = factor;
+        signal.offset = offset;
+        signal.minimum = min_val;
+        signal.maximum = max_val;
+        signal.unit = std::move(unit);
+        if (mux_val) {
+            signal.multiplex = DBCSignal::Multiplex::Multiplexed;
+            signal.multiplexValue = *mux_val;
+        }
+        this_.definitions[msg_id].messageSignals.push_back(std::move(signal));
+    }
+
+    // The multiplexor switch signal (the "M" in an SG_ line)
+    inline void tag_invoke(
+        def_sg_mux_cpo, DBCHandler &this_,
+        uint32_t msg_id, std::string sig_name,
+        unsigned start_bit, unsigned sig_size, char byte_order, char sign_type,
+        std::string unit, std::vector<size_t> /* receivers */
+    ) {
+        DBCSignal signal;
+        signal.name = std::move(sig_name);
+        signal.startBit = start_bit;
+        signal.length = sig_size;
+        signal.bigEndian = byte_order == '0';
+        signal.isSigned = sign_type == '-';
+        signal.unit = std::move(unit);
+        signal.multiplex = DBCSignal::Multiplex::Multiplexor;
+        this_.definitions[msg_id].messageSignals.push_back(std::move(signal));
     }
 }
 
-#endif // DBC_HANDLER_H
\ No newline at end of file
+#endif // DBC_HANDLER_H
@@ -0,0 +1,106 @@
+#include "decoded_signal_cache.h"
+#include "can_id_index.h"
+
+#include <algorithm>
+#include <memory>
+
+void DecodedSignalCache::setDatabase(const DBCDatabase *newDatabase)
+{
+    database = newDatabase;
+    clear();
+}
+
+void DecodedSignalCache::setBudget(size_t bytes)
+{
+    byteBudget = bytes;
+    evict();
+}
+
+void DecodedSignalCache::clear()
+{
+    blocks.clear();
+    blockMap.clear();
+    bytesUsed = 0;
+}
+
+DecodedSignalCache::Row DecodedSignalCache::row(const CANFrameStore &store, size_t row)
+{
+    if (!hasDecoders() || row >= store.size()) {
+        return Row();
+    }
+
+    size_t index = row / kBlockRows;
+    size_t rows = std::min(kBlockRows, store.size() - index * kBlockRows);
+    auto found = blockMap.find(index);
+    if (found != blockMap.end() && found->second->rows == rows) {
+        blocks.splice(blocks.begin(), blocks, found->second);
+    } else {
+        // A block cut short by the end of the store is decoded again once
+        // more frames arrive
+        if (found != blockMap.end()) {
+            bytesUsed -= found->second->bytes;
+            blocks.erase(found->second);
+        }
+        blocks.emplace_front();
+        Block &block = blocks.front();
+        block.index = index;
+        block.rows = rows;
+        decode(store, block);
+        bytesUsed += block.bytes;
+        blockMap[index] = blocks.begin();
+        evict();
+    }
+
+    const Block &block = blocks.front();
+    size_t local = row - index * kBlockRows;
+    uint32_t offset = block.offsets[local];
+    return {block.rowDecoders[local], block.values.data() + offset, block.present.data() + offset};
+}
+
+void DecodedSignalCache::decode(const CANFrameStore &store, Block &block) const
+{
+    size_t firstRow = block.index * kBlockRows;
+    block.rowDecoders.resize(block.rows);
+    block.offsets.resize(block.rows + 1);
+
+    // Look every frame up first so values and present are sized once
+    uint32_t total = 0;
+    for (size_t i = 0; i < block.rows; ++i) {
+        size_t row = firstRow + i;
+        const MessageDecoder *decoder = nullptr;
+        if (!(store.flags(row) & FrameRemote)) {
+            decoder = database->find(CANIDIndex::keyOf(store.id(row), store.flags(row)), store.interfaceIndex(row));
+        }
+        block.rowDecoders[i] = decoder;
+        block.offsets[i] = total;
+        total += decoder ? static_cast<uint32_t>(decoder->signalCount()) : 0;
+    }
+    block.offsets[block.rows] = total;
+    block.values.resize(total);
+    block.present.resize(total);
+
+    std::unique_ptr<bool[]> present(new bool[total ? total : 1]);
+    for (size_t i = 0; i < block.rows; ++i) {
+        if (const MessageDecoder *decoder = block.rowDecoders[i]) {
+            size_t row = firstRow + i;
+            uint32_t offset = block.offsets[i];
+            decoder->decode(store.payload(row), store.dlc(row), block.values.data() + offset, present.get() + offset);
+        }
+    }
+    std::copy(present.get(), present.get() + total, block.present.begin());
+
+    block.bytes = sizeof(Block) + block.rowDecoders.capacity() * sizeof(const MessageDecoder *)
+                + block.offsets.capacity() * sizeof(uint32_t) + block.values.capacity() * sizeof(double)
+                + block.present.capacity();
+}
+
+void DecodedSignalCache::evict()
+{
+    // The most recent block is always kept, whatever the budget
+    while (bytesUsed > byteBudget && blocks.size() > 1) {
+        Block &oldest = blocks.back();
+        bytesUsed -= oldest.bytes;
+        blockMap.erase(oldest.index);
+        blocks.pop_back();
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef DECODED_SIGNAL_CACHE_H
+#define DECODED_SIGNAL_CACHE_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "frame_store.h"
+#include "dbc_database.h"
+
+// Decoded signal values for the rows the table actually shows. Rows are
+// decoded a block at a time on first access and the blocks are kept in
+// least-recently-used order under a byte budget, so scrolling through a
+// huge log decodes only what was looked at and memory stays bounded.
+class DecodedSignalCache
+{
+public:
+    static constexpr size_t kBlockRows = 256;
+    static constexpr size_t kDefaultBudget = 64 * 1024 * 1024;
+
+    // Signals of one frame; decoder is null for frames without a DBC message
+    struct Row {
+        const MessageDecoder *decoder = nullptr;
+        const double *values = nullptr;
+        const uint8_t *present = nullptr;
+    };
+
+    // database must outlive the cache or be replaced before it is reloaded.
+    // Drops every cached block.
+    void setDatabase(const DBCDatabase *database);
+    bool hasDecoders() const { return database && !database->empty(); }
+
+    void setBudget(size_t bytes);
+    size_t budget() const { return byteBudget; }
+    size_t memoryUsage() const { return bytesUsed; }
+
+    void clear();
+
+    // The returned pointers stay valid until the next call
+    Row row(const CANFrameStore &store, size_t row);
+
+private:
+    struct Block {
+        size_t index = 0;
+        size_t rows = 0;                           // fewer than kBlockRows at the end of the store
+        std::vector<const MessageDecoder *> rowDecoders;
+        std::vector<uint32_t> offsets;             // rows + 1 starts into values and present
+        std::vector<double> values;
+        std::vector<uint8_t> present;
+        size_t bytes = 0;
+    };
+
+    void decode(const CANFrameStore &store, Block &block) const;
+    void evict();
+
+    const DBCDatabase *database = nullptr;
+    std::list<Block> blocks;  // most recently used first
+    std::unordered_map<size_t, std::list<Block>::iterator> blockMap;
+    size_t byteBudget = kDefaultBudget;
+    size_t bytesUsed = 0;
+};
+
+#endif // DECODED_SIGNAL_CACHE_H
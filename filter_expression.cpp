@@ -0,0 +1,640 @@
+#include "filter_expression.h"
+#include "can_id_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <utility>
+#include <thread>
+
+namespace {
+
+// Rows below this are filtered on the calling thread
+constexpr size_t kMinRowsPerThread = 16 * FilterExpression::kBlockRows;
+
+constexpr uint16_t kNoInterface = 0xFFFF;
+
+struct Token {
+    enum Kind { End, Identifier, Number, String, Symbol } kind = End;
+    std::string_view text;
+    uint64_t number = 0;
+    size_t position = 0;
+};
+
+bool equalsLower(std::string_view text, std::string_view lower)
+{
+    return text.size() == lower.size()
+        && std::equal(text.begin(), text.end(), lower.begin(),
+                      [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+}
+
+template <typename T, typename Cmp>
+void compareColumn(const T *column, size_t count, uint32_t mask, uint32_t value, uint8_t *out, Cmp cmp)
+{
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = cmp(static_cast<uint32_t>(column[i]) & mask, value);
+    }
+}
+
+template <typename Cmp>
+void compareBytes(const uint8_t *payloads, const uint8_t *dlcs, const uint8_t *flags, size_t count,
+                  uint8_t byteIndex, uint32_t mask, uint32_t value, uint8_t *out, Cmp cmp)
+{
+    // Remote frames have a DLC but no data bytes to match
+    const uint8_t *column = payloads + byteIndex;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = cmp(column[i * CANFrameStore::kPayloadStride] & mask, value) & (dlcs[i] > byteIndex)
+               & ((flags[i] & FrameRemote) == 0);
+    }
+}
+
+// Instantiates fn with a comparison functor matching compare
+template <typename Fn>
+void withCompare(uint8_t compare, uint32_t span, Fn &&fn)
+{
+    switch (compare) {
+        case 0: fn(std::equal_to<uint32_t>()); break;
+        case 1: fn(std::not_equal_to<uint32_t>()); break;
+        case 2: fn(std::less<uint32_t>()); break;
+        case 3: fn(std::less_equal<uint32_t>()); break;
+        case 4: fn(std::greater<uint32_t>()); break;
+        case 5: fn(std::greater_equal<uint32_t>()); break;
+        default:
+            // One unsigned compare covers both ends of the range
+            fn([span](uint32_t x, uint32_t low) { return x - low <= span; });
+            break;
+    }
+}
+
+} // namespace
+
+class FilterExpression::Parser
+{
+public:
+    Parser(std::string_view text, FilterExpression &expression)
+        : text(text), expression(expression)
+    {
+        advance();
+    }
+
+    bool parse()
+    {
+        if (!parseOr()) {
+            return false;
+        }
+        if (token.kind != Token::End) {
+            return fail("Unexpected '" + std::string(token.text) + "'");
+        }
+        return true;
+    }
+
+private:
+    bool fail(const std::string &message)
+    {
+        return failAt(message, token.position);
+    }
+
+    bool failAt(const std::string &message, size_t position)
+    {
+        if (expression.error.empty()) {
+            expression.error = message + " at position " + std::to_string(position + 1);
+        }
+        return false;
+    }
+
+    bool isSymbol(std::string_view symbol) const { return token.kind == Token::Symbol && token.text == symbol; }
+    bool isKeyword(std::string_view keyword) const
+    {
+        return token.kind == Token::Identifier && equalsLower(token.text, keyword);
+    }
+
+    void advance()
+    {
+        while (cursor < text.size() && std::isspace(static_cast<unsigned char>(text[cursor]))) {
+            ++cursor;
+        }
+        token = Token();
+        token.position = cursor;
+        if (cursor >= text.size()) {
+            return;
+        }
+
+        size_t start = cursor;
+        char c = text[cursor];
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            while (cursor < text.size()
+                   && (std::isalnum(static_cast<unsigned char>(text[cursor])) || text[cursor] == '_')) {
+                ++cursor;
+            }
+            token.kind = Token::Identifier;
+        } else if (std::isdigit(static_cast<unsigned char>(c))) {
+            int base = 10;
+            if (c == '0' && cursor + 1 < text.size() && (text[cursor + 1] == 'x' || text[cursor + 1] == 'X')) {
+                base = 16;
+                cursor += 2;
+            }
+            bool valid = true;
+            size_t digitsStart = cursor;
+            while (cursor < text.size() && std::isxdigit(static_cast<unsigned char>(text[cursor]))) {
+                int digit = std::isdigit(static_cast<unsigned char>(text[cursor]))
+                          ? text[cursor] - '0'
+                          : std::tolower(static_cast<unsigned char>(text[cursor])) - 'a' + 10;
+                valid = valid && digit < base && token.number <= (UINT32_MAX - digit) / base;
+                token.number = token.number * base + digit;
+                ++cursor;
+            }
+            token.kind = valid && cursor > digitsStart ? Token::Number : Token::Symbol;
+        } else if (c == '"' || c == '\'') {
+            size_t close = text.find(c, cursor + 1);
+            if (close == std::string_view::npos) {
+                cursor = text.size();
+                token.kind = Token::Symbol;
+            } else {
+                cursor = close + 1;
+                token.kind = Token::String;
+                token.text = text.substr(start + 1, close - start - 1);
+                return;
+            }
+        } else {
+            static constexpr std::string_view twoChar[] = {"==", "!=", "<=", ">=", "&&", "||", ".."};
+            token.kind = Token::Symbol;
+            cursor += 1;
+            for (std::string_view symbol : twoChar) {
+                if (text.substr(start, 2) == symbol) {
+                    cursor = start + 2;
+                    break;
+                }
+            }
+        }
+        token.text = text.substr(start, cursor - start);
+    }
+
+    void emit(OpCode op, uint16_t predicate = 0)
+    {
+        expression.program.push_back({op, predicate});
+    }
+
+    bool parseOr()
+    {
+        if (!parseAnd()) {
+            return false;
+        }
+        while (isSymbol("||") || isKeyword("or")) {
+            advance();
+            if (!parseAnd()) {
+                return false;
+            }
+            emit(OpCode::Or);
+        }
+        return true;
+    }
+
+    bool parseAnd()
+    {
+        if (!parseNot()) {
+            return false;
+        }
+        while (isSymbol("&&") || isKeyword("and")) {
+            advance();
+            if (!parseNot()) {
+                return false;
+            }
+            emit(OpCode::And);
+        }
+        return true;
+    }
+
+    bool parseNot()
+    {
+        if (isSymbol("!") || isKeyword("not")) {
+            advance();
+            if (!parseNot()) {
+                return false;
+            }
+            emit(OpCode::Not);
+            return true;
+        }
+        if (isSymbol("(")) {
+            advance();
+            if (!parseOr()) {
+                return false;
+            }
+            if (!isSymbol(")")) {
+                return fail("Expected ')'");
+            }
+            advance();
+            return true;
+        }
+        return parsePredicate();
+    }
+
+    bool parseNumber(uint32_t &value)
+    {
+        if (token.kind != Token::Number) {
+            return fail("Expected a number");
+        }
+        value = static_cast<uint32_t>(token.number);
+        advance();
+        return true;
+    }
+
+    bool parseIndex(uint32_t limit, uint32_t &index)
+    {
+        if (!isSymbol("[")) {
+            return fail("Expected '['");
+        }
+        advance();
+        if (!parseNumber(index)) {
+            return false;
+        }
+        if (index >= limit) {
+            return fail("Index " + std::to_string(index) + " is past the end of a frame");
+        }
+        if (!isSymbol("]")) {
+            return fail("Expected ']'");
+        }
+        advance();
+        return true;
+    }
+
+    bool parseCompare(Compare &compare)
+    {
+        static constexpr std::pair<std::string_view, Compare> operators[] = {
+            {"==", Compare::Equal}, {"=", Compare::Equal}, {"!=", Compare::NotEqual},
+            {"<", Compare::Less}, {"<=", Compare::LessEqual},
+            {">", Compare::Greater}, {">=", Compare::GreaterEqual},
+        };
+        for (const auto &[symbol, op] : operators) {
+            if (isSymbol(symbol)) {
+                compare = op;
+                advance();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parsePredicate()
+    {
+        if (token.kind != Token::Identifier) {
+            return fail("Expected a field such as id, dlc or data[0]");
+        }
+
+        Predicate predicate;
+        bool isBit = false;
+        std::string_view name = token.text;
+        size_t namePosition = token.position;
+        advance();
+
+        if (equalsLower(name, "id")) {
+            predicate.field = Field::ID;
+        } else if (equalsLower(name, "dlc") || equalsLower(name, "len")) {
+            predicate.field = Field::DLC;
+        } else if (equalsLower(name, "ext") || equalsLower(name, "extended")) {
+            predicate.field = Field::Flag;
+            predicate.mask = FrameExtended;
+        } else if (equalsLower(name, "rtr") || equalsLower(name, "remote")) {
+            predicate.field = Field::Flag;
+            predicate.mask = FrameRemote;
+        } else if (equalsLower(name, "fd")) {
+            predicate.field = Field::Flag;
+            predicate.mask = FrameFD;
+        } else if (equalsLower(name, "brs")) {
+            predicate.field = Field::Flag;
+            predicate.mask = FrameBRS;
+        } else if (equalsLower(name, "esi")) {
+            predicate.field = Field::Flag;
+            predicate.mask = FrameESI;
+        } else if (equalsLower(name, "err") || equalsLower(name, "error")) {
+            predicate.field = Field::Flag;
+            predicate.mask = FrameError;
+        } else if (equalsLower(name, "iface") || equalsLower(name, "interface") || equalsLower(name, "bus")) {
+            predicate.field = Field::Interface;
+        } else if (equalsLower(name, "data") || equalsLower(name, "byte")) {
+            uint32_t index = 0;
+            if (!parseIndex(64, index)) {
+                return false;
+            }
+            predicate.field = Field::Byte;
+            predicate.byteIndex = static_cast<uint8_t>(index);
+            predicate.mask = 0xFF;
+        } else if (equalsLower(name, "bit")) {
+            uint32_t index = 0;
+            if (!parseIndex(64 * 8, index)) {
+                return false;
+            }
+            predicate.field = Field::Byte;
+            predicate.byteIndex = static_cast<uint8_t>(index / 8);
+            predicate.mask = 1U << (index % 8);
+            isBit = true;
+        } else {
+            return failAt("Unknown field '" + std::string(name) + "'", namePosition);
+        }
+
+        bool maskable = predicate.field == Field::ID || predicate.field == Field::DLC
+                     || (predicate.field == Field::Byte && !isBit);
+        if (maskable && isSymbol("&")) {
+            advance();
+            uint32_t mask = 0;
+            if (!parseNumber(mask)) {
+                return false;
+            }
+            predicate.mask &= mask;
+        }
+
+        if (predicate.field == Field::Interface) {
+            if (!parseCompare(predicate.compare)
+                || (predicate.compare != Compare::Equal && predicate.compare != Compare::NotEqual)) {
+                return fail("Interfaces can only be compared with == or !=");
+            }
+            if (token.kind == Token::End || token.kind == Token::Symbol) {
+                return fail("Expected an interface name");
+            }
+            predicate.interfaceName = std::string(token.text);
+            advance();
+        } else if (isKeyword("in")) {
+            advance();
+            uint32_t low = 0;
+            uint32_t high = 0;
+            if (!parseNumber(low)) {
+                return false;
+            }
+            if (!isSymbol("..")) {
+                return fail("Expected '..'");
+            }
+            advance();
+            if (!parseNumber(high)) {
+                return false;
+            }
+            if (high < low) {
+                return fail("Empty range");
+            }
+            predicate.compare = Compare::Between;
+            predicate.value = low;
+            predicate.span = high - low;
+        } else if (parseCompare(predicate.compare)) {
+            if (!parseNumber(predicate.value)) {
+                return false;
+            }
+        } else {
+            // A bare field tests for non-zero
+            predicate.compare = Compare::NotEqual;
+            predicate.value = 0;
+        }
+
+        // Flags and bits compare as 0/1 against the masked value
+        if (predicate.field == Field::Flag || isBit) {
+            if (predicate.compare != Compare::Equal && predicate.compare != Compare::NotEqual) {
+                return fail("Flags and bits can only be compared with == or !=");
+            }
+            bool set = predicate.value != 0;
+            predicate.value = predicate.field == Field::Flag ? (set ? 1U : 0U) : (set ? predicate.mask : 0U);
+        }
+
+        if (expression.predicates.size() >= UINT16_MAX) {
+            return fail("Filter is too long");
+        }
+        emit(OpCode::Test, static_cast<uint16_t>(expression.predicates.size()));
+        expression.predicates.push_back(std::move(predicate));
+        return true;
+    }
+
+    std::string_view text;
+    FilterExpression &expression;
+    size_t cursor = 0;
+    Token token;
+};
+
+bool FilterExpression::compile(std::string_view text)
+{
+    predicates.clear();
+    program.clear();
+    stackDepth = 0;
+    error.clear();
+
+    Parser parser(text, *this);
+    if (!parser.parse()) {
+        predicates.clear();
+        program.clear();
+        return false;
+    }
+
+    size_t depth = 0;
+    for (const Instruction &instruction : program) {
+        if (instruction.op == OpCode::Test) {
+            stackDepth = std::max(stackDepth, ++depth);
+        } else if (instruction.op != OpCode::Not) {
+            --depth;
+        }
+    }
+    return true;
+}
+
+bool FilterExpression::usesOnlyID() const
+{
+    return std::all_of(predicates.begin(), predicates.end(), [](const Predicate &predicate) {
+        return predicate.field == Field::ID || (predicate.field == Field::Flag && predicate.mask == FrameExtended);
+    });
+}
+
+void FilterExpression::test(const Predicate &predicate, const Block &block, uint16_t interfaceIndex,
+                            uint8_t *out) const
+{
+    size_t count = block.count;
+    uint8_t compare = static_cast<uint8_t>(predicate.compare);
+    switch (predicate.field) {
+        case Field::ID:
+            withCompare(compare, predicate.span, [&](auto cmp) {
+                compareColumn(block.ids, count, predicate.mask, predicate.value, out, cmp);
+            });
+            break;
+        case Field::DLC:
+            withCompare(compare, predicate.span, [&](auto cmp) {
+                compareColumn(block.dlcs, count, predicate.mask, predicate.value, out, cmp);
+            });
+            break;
+        case Field::Flag: {
+            uint8_t bit = static_cast<uint8_t>(predicate.mask);
+            uint8_t expected = static_cast<uint8_t>(predicate.value);
+            bool equal = predicate.compare == Compare::Equal;
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = (((block.flags[i] & bit) != 0) == expected) == equal;
+            }
+            break;
+        }
+        case Field::Interface: {
+            bool equal = predicate.compare == Compare::Equal;
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = (block.interfaces[i] == interfaceIndex) == equal;
+            }
+            break;
+        }
+        case Field::Byte:
+            if (predicate.byteIndex < CANFrameStore::kPayloadStride) {
+                withCompare(compare, predicate.span, [&](auto cmp) {
+                    compareBytes(block.payloads, block.dlcs, block.flags, count, predicate.byteIndex,
+                                 predicate.mask, predicate.value, out, cmp);
+                });
+            } else {
+                // Only long FD frames reach here, their bytes live in the side table
+                withCompare(compare, predicate.span, [&](auto cmp) {
+                    for (size_t i = 0; i < count; ++i) {
+                        out[i] = block.dlcs[i] > predicate.byteIndex
+                              && cmp(block.store->payload(block.firstRow + i)[predicate.byteIndex] & predicate.mask,
+                                     predicate.value);
+                    }
+                });
+            }
+            break;
+    }
+}
+
+void FilterExpression::evaluate(const Block &block, const std::vector<uint16_t> &interfaceIndices,
+                                std::vector<uint8_t> &stack) const
+{
+    size_t top = 0;
+    for (const Instruction &instruction : program) {
+        switch (instruction.op) {
+            case OpCode::Test:
+                test(predicates[instruction.predicate], block, interfaceIndices[instruction.predicate],
+                     stack.data() + top * kBlockRows);
+                ++top;
+                break;
+            case OpCode::And:
+            case OpCode::Or: {
+                --top;
+                uint8_t *lhs = stack.data() + (top - 1) * kBlockRows;
+                const uint8_t *rhs = stack.data() + top * kBlockRows;
+                if (instruction.op == OpCode::And) {
+                    for (size_t i = 0; i < block.count; ++i) {
+                        lhs[i] &= rhs[i];
+                    }
+                } else {
+                    for (size_t i = 0; i < block.count; ++i) {
+                        lhs[i] |= rhs[i];
+                    }
+                }
+                break;
+            }
+            case OpCode::Not: {
+                uint8_t *value = stack.data() + (top - 1) * kBlockRows;
+                for (size_t i = 0; i < block.count; ++i) {
+                    value[i] ^= 1;
+                }
+                break;
+            }
+        }
+    }
+}
+
+std::vector<uint32_t> FilterExpression::matchingKeys(const std::vector<uint32_t> &keys) const
+{
+    std::vector<uint32_t> matches;
+    if (!isValid()) {
+        return matches;
+    }
+
+    std::vector<uint32_t> ids(kBlockRows);
+    std::vector<uint8_t> flags(kBlockRows);
+    std::vector<uint8_t> stack(stackDepth * kBlockRows);
+    std::vector<uint16_t> interfaceIndices(predicates.size(), kNoInterface);
+    for (size_t first = 0; first < keys.size(); first += kBlockRows) {
+        Block block;
+        block.count = std::min(kBlockRows, keys.size() - first);
+        for (size_t i = 0; i < block.count; ++i) {
+            ids[i] = CANIDIndex::idOf(keys[first + i]);
+            flags[i] = CANIDIndex::flagsOf(keys[first + i]);
+        }
+        block.ids = ids.data();
+        block.flags = flags.data();
+        evaluate(block, interfaceIndices, stack);
+        for (size_t i = 0; i < block.count; ++i) {
+            if (stack[i]) {
+                matches.push_back(keys[first + i]);
+            }
+        }
+    }
+    return matches;
+}
+
+std::vector<uint32_t> FilterExpression::matchingRows(const CANFrameStore &store, size_t firstRow, size_t lastRow,
+                                                     int threads) const
+{
+    lastRow = std::min(lastRow, store.size());
+    if (!isValid() || firstRow >= lastRow) {
+        return {};
+    }
+
+    // Interface names are resolved to this store's indices once per run
+    std::vector<uint16_t> interfaceIndices(predicates.size(), kNoInterface);
+    const std::vector<std::string> &names = store.interfaceNames();
+    for (size_t i = 0; i < predicates.size(); ++i) {
+        if (predicates[i].field == Field::Interface) {
+            auto it = std::find(names.begin(), names.end(), predicates[i].interfaceName);
+            if (it != names.end()) {
+                interfaceIndices[i] = static_cast<uint16_t>(it - names.begin());
+            }
+        }
+    }
+
+    auto filterRange = [&](size_t begin, size_t end, std::vector<uint32_t> &rows) {
+        std::vector<uint8_t> stack(stackDepth * kBlockRows);
+        for (size_t first = begin; first < end; first += kBlockRows) {
+            Block block;
+            block.firstRow = first;
+            block.count = std::min(kBlockRows, end - first);
+            block.ids = store.ids().data() + first;
+            block.flags = store.flagColumn().data() + first;
+            block.dlcs = store.dlcs().data() + first;
+            block.interfaces = store.interfaceIndices().data() + first;
+            block.payloads = store.payloads().data() + first * CANFrameStore::kPayloadStride;
+            block.store = &store;
+            evaluate(block, interfaceIndices, stack);
+
+            // Branch-free compaction of the 0/1 result into row numbers
+            size_t written = rows.size();
+            rows.resize(written + block.count);
+            for (size_t i = 0; i < block.count; ++i) {
+                rows[written] = static_cast<uint32_t>(first + i);
+                written += stack[i];
+            }
+            rows.resize(written);
+        }
+    };
+
+    size_t totalRows = lastRow - firstRow;
+    size_t workers = threads > 0 ? static_cast<size_t>(threads)
+                                 : std::max<size_t>(1, std::thread::hardware_concurrency());
+    workers = std::max<size_t>(1, std::min(workers, totalRows / kMinRowsPerThread));
+
+    if (workers == 1) {
+        std::vector<uint32_t> rows;
+        filterRange(firstRow, lastRow, rows);
+        return rows;
+    }
+
+    // Contiguous, block-aligned ranges keep every thread's output ascending
+    size_t blocks = (totalRows + kBlockRows - 1) / kBlockRows;
+    std::vector<std::vector<uint32_t>> partial(workers);
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (size_t w = 0; w < workers; ++w) {
+        size_t begin = firstRow + (blocks * w / workers) * kBlockRows;
+        size_t end = std::min(lastRow, firstRow + (blocks * (w + 1) / workers) * kBlockRows);
+        pool.emplace_back(filterRange, begin, end, std::ref(partial[w]));
+    }
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    size_t matches = 0;
+    for (const std::vector<uint32_t> &rows : partial) {
+        matches += rows.size();
+    }
+    std::vector<uint32_t> rows;
+    rows.reserve(matches);
+    for (const std::vector<uint32_t> &part : partial) {
+        rows.insert(rows.end(), part.begin(), part.end());
+    }
+    return rows;
+}
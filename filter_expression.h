@@ -0,0 +1,109 @@
+#ifndef FILTER_EXPRESSION_H
+#define FILTER_EXPRESSION_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "frame_store.h"
+
+// Frame filter language, parsed once and compiled into a postfix program of
+// column predicates. The program runs over blocks of kBlockRows frames: every
+// predicate is one branch-free loop over a store column and boolean operators
+// combine whole blocks of 0/1 bytes, so the compiler vectorizes the inner
+// loops. Blocks are shared out between threads.
+//
+//   id == 0x123                   id in 0x100..0x1FF          id & 0x7F0 == 0x100
+//   data[0] > 10                  data[2] & 0x0F == 3         bit[12]
+//   dlc >= 4                      ext, rtr, fd, err           iface == can1
+//   (id == 0x100 || id == 0x200) && !(data[0] == 0)
+//
+// Numbers are decimal unless written with 0x. "and", "or", "not" work in
+// place of &&, || and !. A field on its own tests for non-zero. Payload
+// bytes and bits beyond a frame's DLC never match.
+class FilterExpression
+{
+public:
+    static constexpr size_t kBlockRows = 4096;
+
+    // Returns false and sets errorString() when text is not a valid filter
+    bool compile(std::string_view text);
+    const std::string &errorString() const { return error; }
+    bool isValid() const { return !program.empty(); }
+
+    // True when only the CAN ID and its format are tested, so the filter can
+    // be decided once per ID instead of once per frame
+    bool usesOnlyID() const;
+
+    // The CANIDIndex keys (see CANIDIndex::keyOf) the filter accepts.
+    // Only meaningful when usesOnlyID() holds.
+    std::vector<uint32_t> matchingKeys(const std::vector<uint32_t> &keys) const;
+
+    // Ascending rows in [firstRow, lastRow) of store the filter accepts.
+    // threads <= 0 uses every core.
+    std::vector<uint32_t> matchingRows(const CANFrameStore &store, size_t firstRow, size_t lastRow,
+                                       int threads = 0) const;
+
+private:
+    enum class Field : uint8_t {
+        ID,
+        DLC,
+        Flag,       // mask holds the CANFrameFlags bit, compared as 0/1
+        Interface,
+        Byte        // payload byte index, masked
+    };
+
+    enum class Compare : uint8_t {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Between     // value <= x && x - value <= span
+    };
+
+    struct Predicate {
+        Field field = Field::ID;
+        Compare compare = Compare::NotEqual;
+        uint8_t byteIndex = 0;
+        uint32_t mask = UINT32_MAX;
+        uint32_t value = 0;
+        uint32_t span = 0;
+        std::string interfaceName;
+    };
+
+    enum class OpCode : uint8_t { Test, And, Or, Not };
+
+    struct Instruction {
+        OpCode op;
+        uint16_t predicate;  // for Test
+    };
+
+    // Columns of one block, already offset to its first row
+    struct Block {
+        const uint32_t *ids = nullptr;
+        const uint8_t *flags = nullptr;
+        const uint8_t *dlcs = nullptr;
+        const uint8_t *interfaces = nullptr;
+        const uint8_t *payloads = nullptr;   // kPayloadStride bytes per row
+        const CANFrameStore *store = nullptr; // for FD bytes past the payload column
+        size_t firstRow = 0;
+        size_t count = 0;
+    };
+
+    class Parser;
+
+    void evaluate(const Block &block, const std::vector<uint16_t> &interfaceIndices,
+                  std::vector<uint8_t> &stack) const;
+    void test(const Predicate &predicate, const Block &block, uint16_t interfaceIndex, uint8_t *out) const;
+
+    std::vector<Predicate> predicates;
+    std::vector<Instruction> program;
+    size_t stackDepth = 0;
+    std::string error;
+};
+
+#endif // FILTER_EXPRESSION_H
@@ -0,0 +1,39 @@
+#ifndef FRAME_FORMAT_H
+#define FRAME_FORMAT_H
+#pragma once
+
+#include <QString>
+#include <cstdint>
+#include "can_log_parser.h"
+
+// Text forms of frame fields, shared by the frame table and the playback view
+
+// "seconds.micros" as candump writes it
+inline QString formatTimestamp(uint64_t timestampNs)
+{
+    return QString("%1.%2")
+        .arg(timestampNs / 1000000000ULL)
+        .arg((timestampNs % 1000000000ULL) / 1000ULL, 6, 10, QChar('0'));
+}
+
+inline QString formatCANID(uint32_t id, uint8_t flags)
+{
+    return QString("%1").arg(id, (flags & FrameExtended) ? 8 : 3, 16, QChar('0')).toUpper();
+}
+
+inline QString formatPayload(const uint8_t *data, uint8_t length, uint8_t flags)
+{
+    if (flags & FrameRemote) {
+        return QString("R%1").arg(length);
+    }
+    static const char digits[] = "0123456789ABCDEF";
+    QString text(length * 2, Qt::Uninitialized);
+    QChar *out = text.data();
+    for (int i = 0; i < length; ++i) {
+        *out++ = QLatin1Char(digits[data[i] >> 4]);
+        *out++ = QLatin1Char(digits[data[i] & 0x0F]);
+    }
+    return text;
+}
+
+#endif // FRAME_FORMAT_H
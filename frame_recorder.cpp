@@ -0,0 +1,345 @@
+#include "frame_recorder.h"
+#include "can_record_file.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QThread>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+namespace {
+constexpr uint32_t kErrFlag = 0x20000000U;  // CAN_ERR_FLAG
+
+// Longest candump line without its interface name: timestamp, an 8-digit
+// ID, the FD marker and 64 payload bytes, with room to spare
+constexpr size_t kMaxLineBytes = 192;
+
+size_t formatCandumpLine(char *out, const CANFrameStore &store, size_t row)
+{
+    static constexpr char kHex[] = "0123456789ABCDEF";
+    char *p = out;
+
+    // "(seconds.micros) " as candump -l writes it
+    uint64_t timestamp = store.timestamp(row);
+    *p++ = '(';
+    p = std::to_chars(p, p + 20, timestamp / 1000000000ULL).ptr;
+    *p++ = '.';
+    uint32_t micros = static_cast<uint32_t>(timestamp % 1000000000ULL / 1000);
+    for (int digit = 5; digit >= 0; --digit) {
+        p[digit] = static_cast<char>('0' + micros % 10);
+        micros /= 10;
+    }
+    p += 6;
+    *p++ = ')';
+    *p++ = ' ';
+
+    const std::string &interfaceName = store.interfaceName(row);
+    std::memcpy(p, interfaceName.data(), interfaceName.size());
+    p += interfaceName.size();
+    *p++ = ' ';
+
+    // Extended and error frames use 8 ID digits, standard frames 3
+    uint8_t flags = store.flags(row);
+    uint32_t id = store.id(row);
+    int idDigits = 3;
+    if (flags & (FrameExtended | FrameError)) {
+        idDigits = 8;
+        if (flags & FrameError) {
+            id |= kErrFlag;
+        }
+    }
+    for (int digit = idDigits - 1; digit >= 0; --digit) {
+        *p++ = kHex[(id >> (digit * 4)) & 0xF];
+    }
+    *p++ = '#';
+
+    if (flags & FrameRemote) {
+        *p++ = 'R';
+        *p++ = static_cast<char>('0' + store.dlc(row));
+    } else {
+        if (flags & FrameFD) {
+            *p++ = '#';
+            *p++ = kHex[((flags & FrameBRS) ? 0x1 : 0) | ((flags & FrameESI) ? 0x2 : 0)];
+        }
+        const uint8_t *data = store.payload(row);
+        for (uint8_t i = 0; i < store.dlc(row); ++i) {
+            *p++ = kHex[data[i] >> 4];
+            *p++ = kHex[data[i] & 0xF];
+        }
+    }
+    *p++ = '\n';
+    return static_cast<size_t>(p - out);
+}
+
+QString sequencePath(const QString &path, int sequence)
+{
+    QFileInfo info(path);
+    QString name = QString("%1_%2").arg(info.completeBaseName()).arg(sequence, 4, 10, QChar('0'));
+    if (!info.suffix().isEmpty()) {
+        name += "." + info.suffix();
+    }
+    return info.dir().filePath(name);
+}
+}
+
+void FrameRecorder::AlignedFree::operator()(uint8_t *buffer) const
+{
+    ::operator delete[](buffer, std::align_val_t(kBufferAlignment));
+}
+
+FrameRecorder::Format FrameRecorder::formatForPath(const QString &path)
+{
+    return path.endsWith(".canrec", Qt::CaseInsensitive) ? Format::Binary : Format::CandumpLog;
+}
+
+FrameRecorder::FrameRecorder(QObject *parent)
+    : QObject(parent)
+{
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    stop();
+}
+
+bool FrameRecorder::start(const Settings &newSettings)
+{
+    stop();
+    settings = newSettings;
+    if (!buffer) {
+        buffer.reset(static_cast<uint8_t *>(::operator new[](kBufferBytes, std::align_val_t(kBufferAlignment))));
+    }
+    buffered = 0;
+    bufferedFrames = 0;
+    lastFlush = std::chrono::steady_clock::now();
+    writeFailed = false;
+    stopRequested = false;
+    queue.clear();
+    framesWritten = 0;
+    bytesWritten = 0;
+    filesOpened = 0;
+
+    QString message;
+    if (!openFile(1, message)) {
+        error = message;
+        return false;
+    }
+    error.clear();
+
+    worker = QThread::create([this]() { run(); });
+    worker->start();
+    return true;
+}
+
+void FrameRecorder::stop()
+{
+    if (!worker) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    queued.notify_one();
+    worker->wait();
+    delete worker;
+    worker = nullptr;
+}
+
+QString FrameRecorder::currentFile() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return currentPath;
+}
+
+FrameRecorder::Counters FrameRecorder::counters() const
+{
+    Counters counters;
+    counters.frames = framesWritten.load(std::memory_order_relaxed);
+    counters.bytes = bytesWritten.load(std::memory_order_relaxed);
+    counters.files = filesOpened.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void FrameRecorder::write(const CANFrameStore &chunk)
+{
+    if (!worker || chunk.empty()) {
+        return;
+    }
+    auto copy = std::make_shared<const CANFrameStore>(chunk);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(copy));
+    }
+    queued.notify_one();
+}
+
+void FrameRecorder::run()
+{
+    for (;;) {
+        std::shared_ptr<const CANFrameStore> chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (queue.empty() && !stopRequested) {
+                queued.wait_for(lock, std::chrono::milliseconds(kFlushMs));
+            }
+            if (!queue.empty()) {
+                chunk = std::move(queue.front());
+                queue.pop_front();
+            } else if (stopRequested) {
+                break;
+            }
+        }
+
+        if (writeFailed) {
+            continue;
+        }
+        if (chunk) {
+            record(*chunk);
+        }
+        // A quiet bus still gets its frames onto the disk within kFlushMs
+        if (buffered > 0 && std::chrono::steady_clock::now() - lastFlush >= std::chrono::milliseconds(kFlushMs)) {
+            flush();
+        }
+    }
+
+    if (!writeFailed) {
+        flush();
+    }
+    file.close();
+}
+
+void FrameRecorder::record(const CANFrameStore &chunk)
+{
+    bool filtered = settings.filter.isValid();
+    std::vector<uint32_t> rows;
+    if (filtered) {
+        rows = settings.filter.matchingRows(chunk, 0, chunk.size(), 1);
+    }
+    size_t count = filtered ? rows.size() : chunk.size();
+    bool binary = settings.format == Format::Binary;
+    uint64_t rotateNs = static_cast<uint64_t>(settings.rotateSeconds) * 1000000000ULL;
+
+    // .canrec interface index of each of the chunk's interfaces, -1 until
+    // looked up in the current file
+    std::vector<int> interfaceIndex(chunk.interfaceNames().size(), -1);
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t row = filtered ? rows[i] : i;
+        uint64_t timestamp = chunk.timestamp(row);
+
+        if (fileFrames > 0 && ((settings.rotateBytes > 0 && fileBytes >= settings.rotateBytes)
+                               || (rotateNs > 0 && timestamp >= fileFirstTimestamp + rotateNs))) {
+            if (!rotate()) {
+                break;
+            }
+            std::fill(interfaceIndex.begin(), interfaceIndex.end(), -1);
+        }
+
+        const std::string &interfaceName = chunk.interfaceName(row);
+        size_t maxBytes = binary ? CANRecordFile::kMaxFrameBytes + CANRecordFile::kMaxInterfaceBytes
+                                 : kMaxLineBytes + interfaceName.size();
+        if (buffered + maxBytes > kBufferBytes && !flush()) {
+            break;
+        }
+
+        size_t bytes = 0;
+        if (binary) {
+            int &index = interfaceIndex[chunk.interfaceIndex(row)];
+            if (index < 0) {
+                auto [it, added] = fileInterfaces.try_emplace(interfaceName, static_cast<uint8_t>(fileInterfaces.size()));
+                index = it->second;
+                if (added) {
+                    bytes += CANRecordFile::writeInterface(buffer.get() + buffered, it->second, interfaceName);
+                }
+            }
+            bytes += CANRecordFile::writeFrame(buffer.get() + buffered + bytes, chunk, row, static_cast<uint8_t>(index));
+        } else {
+            bytes = formatCandumpLine(reinterpret_cast<char *>(buffer.get() + buffered), chunk, row);
+        }
+        buffered += bytes;
+        fileBytes += static_cast<qint64>(bytes);
+        if (fileFrames++ == 0) {
+            fileFirstTimestamp = timestamp;
+        }
+        ++bufferedFrames;
+    }
+}
+
+bool FrameRecorder::openFile(int sequence, QString &message)
+{
+    bool rotating = settings.rotateBytes > 0 || settings.rotateSeconds > 0;
+    QString path = rotating ? sequencePath(settings.path, sequence) : settings.path;
+
+    // The recorder does its own buffering, every write goes straight down
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        message = QString("Unable to create %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    fileSequence = sequence;
+    fileFrames = 0;
+    fileBytes = 0;
+    fileFirstTimestamp = 0;
+    fileInterfaces.clear();
+    if (settings.format == Format::Binary) {
+        buffered += CANRecordFile::writeHeader(buffer.get() + buffered);
+        fileBytes += CANRecordFile::kHeaderBytes;
+    }
+    filesOpened.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentPath = path;
+    }
+    return true;
+}
+
+bool FrameRecorder::rotate()
+{
+    if (!flush()) {
+        return false;
+    }
+    file.close();
+    QString message;
+    if (!openFile(fileSequence + 1, message)) {
+        fail(message);
+        return false;
+    }
+    return true;
+}
+
+bool FrameRecorder::flush()
+{
+    lastFlush = std::chrono::steady_clock::now();
+    if (buffered == 0) {
+        return true;
+    }
+    qint64 written = file.write(reinterpret_cast<const char *>(buffer.get()), static_cast<qint64>(buffered));
+    if (written != static_cast<qint64>(buffered)) {
+        fail(QString("Writing %1 failed: %2").arg(file.fileName(), file.errorString()));
+        return false;
+    }
+    // Counted once on disk, so a failed write leaves the counters accurate
+    bytesWritten.fetch_add(buffered, std::memory_order_relaxed);
+    framesWritten.fetch_add(bufferedFrames, std::memory_order_relaxed);
+    buffered = 0;
+    bufferedFrames = 0;
+    return true;
+}
+
+void FrameRecorder::fail(const QString &message)
+{
+    // Reported once on the GUI thread; the I/O thread drops frames from here on
+    writeFailed = true;
+    buffered = 0;
+    bufferedFrames = 0;
+    QMetaObject::invokeMethod(this, [this, message]() {
+        error = message;
+        emit failed(message);
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,117 @@
+#ifndef FRAME_RECORDER_H
+#define FRAME_RECORDER_H
+#pragma once
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "filter_expression.h"
+#include "frame_store.h"
+
+class QThread;
+
+// Writes frames to disk on its own I/O thread, as candump .log text or as a
+// binary .canrec recording (see can_record_file.h). The GUI thread only
+// queues chunks; the I/O thread filters and formats them into one large
+// aligned buffer and hands the file whole kBufferBytes blocks, at least once
+// every kFlushMs. Files rotate once they reach a size or cover a span of log
+// time.
+class FrameRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr size_t kBufferBytes = 4 * 1024 * 1024;
+    static constexpr size_t kBufferAlignment = 4096;
+    static constexpr int kFlushMs = 1000;
+
+    enum class Format { CandumpLog, Binary };
+
+    struct Settings {
+        QString path;               // rotated files get _0001, _0002, ... before the suffix
+        Format format = Format::CandumpLog;
+        qint64 rotateBytes = 0;     // 0 never rotates by size
+        qint64 rotateSeconds = 0;   // of log time, 0 never rotates by time
+        FilterExpression filter;    // every frame is recorded when not valid
+    };
+
+    struct Counters {
+        uint64_t frames = 0;  // frames written to disk, after filtering
+        uint64_t bytes = 0;   // over every file
+        int files = 0;
+    };
+
+    static Format formatForPath(const QString &path);
+
+    explicit FrameRecorder(QObject *parent = nullptr);
+    ~FrameRecorder();
+
+    // Opens the first file and starts the I/O thread. Returns false with
+    // errorString() set if the file cannot be created.
+    bool start(const Settings &settings);
+
+    // Writes out everything queued and closes the file
+    void stop();
+
+    bool isRecording() const { return worker != nullptr; }
+    QString errorString() const { return error; }
+    QString currentFile() const;
+    Counters counters() const;
+
+    // Queues a copy of chunk for writing; capture-sized chunks are cheap to copy
+    void write(const CANFrameStore &chunk);
+
+signals:
+    // Writing stopped after an I/O error; frames queued afterwards are dropped
+    void failed(const QString &message);
+
+private:
+    struct AlignedFree {
+        void operator()(uint8_t *buffer) const;
+    };
+
+    void run();
+    void record(const CANFrameStore &chunk);
+    bool openFile(int sequence, QString &message);
+    bool rotate();
+    bool flush();
+    void fail(const QString &message);
+
+    Settings settings;
+    QFile file;
+    int fileSequence = 0;
+    uint64_t fileFirstTimestamp = 0;
+    uint64_t fileFrames = 0;
+    qint64 fileBytes = 0;               // written and buffered
+    std::unordered_map<std::string, uint8_t> fileInterfaces;  // .canrec indices defined in the file
+    std::unique_ptr<uint8_t[], AlignedFree> buffer;
+    size_t buffered = 0;
+    uint64_t bufferedFrames = 0;        // formatted into buffer, not yet written
+    std::chrono::steady_clock::time_point lastFlush;
+    bool writeFailed = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable queued;
+    std::deque<std::shared_ptr<const CANFrameStore>> queue;
+    bool stopRequested = false;
+    QString currentPath;                // guarded by mutex
+
+    std::atomic<uint64_t> framesWritten{0};
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<int> filesOpened{0};
+    QString error;
+    QThread *worker = nullptr;
+};
+
+#endif // FRAME_RECORDER_H
@@ -0,0 +1,217 @@
+#include "frame_store.h"
+
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+
+namespace {
+constexpr size_t kFDPayloadSize = 64;
+}
+
+void CANFrameStore::clear()
+{
+    timestampColumn.clear();
+    idColumn.clear();
+    dlcColumn.clear();
+    flagsColumn.clear();
+    interfaceColumn.clear();
+    payloadColumn.clear();
+    fdRows.clear();
+    fdPayloads.clear();
+    interfaces.clear();
+}
+
+void CANFrameStore::reserve(size_t frames)
+{
+    timestampColumn.reserve(frames);
+    idColumn.reserve(frames);
+    dlcColumn.reserve(frames);
+    flagsColumn.reserve(frames);
+    interfaceColumn.reserve(frames);
+    payloadColumn.reserve(frames * kPayloadStride);
+}
+
+void CANFrameStore::shrinkToFit()
+{
+    timestampColumn.shrink_to_fit();
+    idColumn.shrink_to_fit();
+    dlcColumn.shrink_to_fit();
+    flagsColumn.shrink_to_fit();
+    interfaceColumn.shrink_to_fit();
+    payloadColumn.shrink_to_fit();
+    fdRows.shrink_to_fit();
+    fdPayloads.shrink_to_fit();
+}
+
+bool CANFrameStore::internInterface(std::string_view name, uint8_t &index)
+{
+    // Logs rarely carry more than a handful of interfaces, a linear scan wins
+    for (size_t i = 0; i < interfaces.size(); ++i) {
+        if (interfaces[i] == name) {
+            index = static_cast<uint8_t>(i);
+            return true;
+        }
+    }
+    if (interfaces.size() >= kMaxInterfaces) {
+        return false;
+    }
+    interfaces.emplace_back(name);
+    index = static_cast<uint8_t>(interfaces.size() - 1);
+    return true;
+}
+
+bool CANFrameStore::append(const CANFrame &frame)
+{
+    uint8_t interfaceIndex;
+    if (!internInterface(frame.interfaceName, interfaceIndex)) {
+        return false;
+    }
+
+    size_t row = idColumn.size();
+    uint8_t length = std::min<uint8_t>(frame.dlc, kFDPayloadSize);
+    uint8_t payloadLength = length;
+    if (frame.flags & FrameRemote) {
+        // A remote request keeps its requested length but carries no data
+        length = std::min<uint8_t>(length, kPayloadStride);
+        payloadLength = 0;
+    }
+
+    timestampColumn.push_back(frame.timestampNs);
+    idColumn.push_back(frame.id);
+    dlcColumn.push_back(length);
+    flagsColumn.push_back(frame.flags);
+    interfaceColumn.push_back(interfaceIndex);
+
+    payloadColumn.resize(payloadColumn.size() + kPayloadStride, 0);
+    std::memcpy(payloadColumn.mutableData() + row * kPayloadStride, frame.data,
+                std::min<size_t>(payloadLength, kPayloadStride));
+
+    if (payloadLength > kPayloadStride) {
+        fdRows.push_back(row);
+        fdPayloads.resize(fdPayloads.size() + kFDPayloadSize, 0);
+        std::memcpy(fdPayloads.mutableData() + fdPayloads.size() - kFDPayloadSize, frame.data, length);
+    }
+    return true;
+}
+
+bool CANFrameStore::canAppend(const CANFrameStore &other) const
+{
+    size_t added = 0;
+    for (const std::string &name : other.interfaces) {
+        added += std::find(interfaces.begin(), interfaces.end(), name) == interfaces.end();
+    }
+    return interfaces.size() + added <= kMaxInterfaces;
+}
+
+bool CANFrameStore::append(const CANFrameStore &other)
+{
+    if (!canAppend(other)) {
+        return false;
+    }
+
+    // Interface indices are local to each store, remap them onto ours
+    uint8_t remap[kMaxInterfaces];
+    for (size_t i = 0; i < other.interfaces.size(); ++i) {
+        internInterface(other.interfaces[i], remap[i]);
+    }
+
+    size_t base = size();
+
+    timestampColumn.insert(timestampColumn.end(), other.timestampColumn.begin(), other.timestampColumn.end());
+    idColumn.insert(idColumn.end(), other.idColumn.begin(), other.idColumn.end());
+    dlcColumn.insert(dlcColumn.end(), other.dlcColumn.begin(), other.dlcColumn.end());
+    flagsColumn.insert(flagsColumn.end(), other.flagsColumn.begin(), other.flagsColumn.end());
+    payloadColumn.insert(payloadColumn.end(), other.payloadColumn.begin(), other.payloadColumn.end());
+
+    interfaceColumn.reserve(interfaceColumn.size() + other.interfaceColumn.size());
+    for (uint8_t index : other.interfaceColumn) {
+        interfaceColumn.push_back(remap[index]);
+    }
+
+    for (uint64_t row : other.fdRows) {
+        fdRows.push_back(base + row);
+    }
+    fdPayloads.insert(fdPayloads.end(), other.fdPayloads.begin(), other.fdPayloads.end());
+    return true;
+}
+
+void CANFrameStore::swap(CANFrameStore &other)
+{
+    timestampColumn.swap(other.timestampColumn);
+    idColumn.swap(other.idColumn);
+    dlcColumn.swap(other.dlcColumn);
+    flagsColumn.swap(other.flagsColumn);
+    interfaceColumn.swap(other.interfaceColumn);
+    payloadColumn.swap(other.payloadColumn);
+    fdRows.swap(other.fdRows);
+    fdPayloads.swap(other.fdPayloads);
+    interfaces.swap(other.interfaces);
+}
+
+bool CANFrameStore::isTimeOrdered() const
+{
+    return std::is_sorted(timestampColumn.begin(), timestampColumn.end());
+}
+
+void CANFrameStore::sortByTimestamp()
+{
+    if (isTimeOrdered()) {
+        return;
+    }
+
+    std::vector<size_t> order(size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return timestampColumn[a] < timestampColumn[b];
+    });
+
+    auto gather = [&order](auto &column) {
+        std::remove_reference_t<decltype(column)> sorted;
+        sorted.reserve(column.size());
+        for (size_t row : order) {
+            sorted.push_back(column[row]);
+        }
+        column.swap(sorted);
+    };
+    gather(timestampColumn);
+    gather(idColumn);
+    gather(flagsColumn);
+    gather(interfaceColumn);
+
+    FrameColumn<uint8_t> sortedPayloads;
+    FrameColumn<uint64_t> sortedFdRows;
+    FrameColumn<uint8_t> sortedFdPayloads;
+    sortedPayloads.resize(payloadColumn.size());
+    sortedFdRows.reserve(fdRows.size());
+    sortedFdPayloads.reserve(fdPayloads.size());
+    uint8_t *sortedPayloadData = sortedPayloads.mutableData();
+    for (size_t row = 0; row < order.size(); ++row) {
+        size_t source = order[row];
+        std::memcpy(sortedPayloadData + row * kPayloadStride,
+                    payloadColumn.data() + source * kPayloadStride, kPayloadStride);
+        if (dlcColumn[source] > kPayloadStride) {
+            sortedFdRows.push_back(row);
+            const uint8_t *fd = fdPayload(source);
+            sortedFdPayloads.insert(sortedFdPayloads.end(), fd, fd + kFDPayloadSize);
+        }
+    }
+    gather(dlcColumn);  // after the FD pass, which still needs the old DLCs
+    payloadColumn.swap(sortedPayloads);
+    fdRows.swap(sortedFdRows);
+    fdPayloads.swap(sortedFdPayloads);
+}
+
+const uint8_t *CANFrameStore::fdPayload(size_t row) const
+{
+    auto it = std::lower_bound(fdRows.begin(), fdRows.end(), static_cast<uint64_t>(row));
+    return fdPayloads.data() + static_cast<size_t>(it - fdRows.begin()) * kFDPayloadSize;
+}
+
+size_t CANFrameStore::memoryUsage() const
+{
+    return timestampColumn.capacity() * sizeof(uint64_t)
+         + idColumn.capacity() * sizeof(uint32_t)
+         + dlcColumn.capacity() + flagsColumn.capacity() + interfaceColumn.capacity()
+         + payloadColumn.capacity()
+         + fdRows.capacity() * sizeof(uint64_t) + fdPayloads.capacity();
+}
@@ -0,0 +1,197 @@
+#ifndef FRAME_STORE_H
+#define FRAME_STORE_H
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "can_log_parser.h"
+
+// One column of a CANFrameStore, with the std::vector operations the store
+// needs. It owns its elements, except after a .canidx load, when it views the
+// mapped sidecar in place; the first change copies the elements it views.
+template <typename T>
+class FrameColumn {
+public:
+    FrameColumn() = default;
+    FrameColumn(const FrameColumn &other) : owned(other.begin(), other.end()) { sync(); }
+    FrameColumn(FrameColumn &&other) noexcept { swap(other); }
+    FrameColumn &operator=(FrameColumn other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return owned.capacity(); }  // owned elements only
+    const T *data() const { return elements; }
+    const T *begin() const { return elements; }
+    const T *end() const { return elements + count; }
+    const T &operator[](size_t index) const { return elements[index]; }
+
+    // Views size elements at data; mapping keeps them valid
+    void borrow(const T *data, size_t size, std::shared_ptr<const void> mapping)
+    {
+        owned = std::vector<T>();
+        view = std::move(mapping);
+        elements = data;
+        count = size;
+    }
+    bool isBorrowed() const { return view != nullptr; }
+
+    T *mutableData()
+    {
+        detach();
+        return owned.data();
+    }
+    void push_back(const T &value)
+    {
+        detach();
+        owned.push_back(value);
+        sync();
+    }
+    void resize(size_t size, const T &value = T())
+    {
+        detach();
+        owned.resize(size, value);
+        sync();
+    }
+    void insert(const T *, const T *first, const T *last)  // at the end only
+    {
+        detach();
+        owned.insert(owned.end(), first, last);
+        sync();
+    }
+    void reserve(size_t size)
+    {
+        detach();
+        owned.reserve(size);
+        sync();
+    }
+    void shrink_to_fit()  // a borrowed column holds no spare capacity
+    {
+        if (!view) {
+            owned.shrink_to_fit();
+            sync();
+        }
+    }
+    void clear()
+    {
+        view.reset();
+        owned.clear();
+        sync();
+    }
+    void swap(FrameColumn &other) noexcept
+    {
+        owned.swap(other.owned);
+        view.swap(other.view);
+        std::swap(elements, other.elements);
+        std::swap(count, other.count);
+    }
+
+private:
+    void detach()
+    {
+        if (view) {
+            owned.assign(elements, elements + count);
+            view.reset();
+            sync();
+        }
+    }
+    void sync()
+    {
+        elements = owned.data();
+        count = owned.size();
+    }
+
+    std::vector<T> owned;
+    std::shared_ptr<const void> view;  // the mapping borrowed elements live in
+    const T *elements = nullptr;
+    size_t count = 0;
+};
+
+// Struct-of-arrays store holding every loaded frame. This is the single source
+// of truth for the table, playback, filtering and the ID grid; each frame costs
+// 23 bytes (timestamp 8, ID 4, DLC/flags/interface 3, first 8 payload bytes).
+// FD frames longer than 8 bytes keep their full payload in a side table.
+class CANFrameStore {
+public:
+    static constexpr size_t kPayloadStride = 8;
+    static constexpr size_t kMaxInterfaces = UINT8_MAX + 1;
+
+    size_t size() const { return idColumn.size(); }
+    bool empty() const { return idColumn.empty(); }
+
+    void clear();
+    void reserve(size_t frames);
+    void shrinkToFit();
+
+    // Both return false, storing nothing, when the result would name more
+    // than kMaxInterfaces interfaces
+    bool append(const CANFrame &frame);
+    bool append(const CANFrameStore &other);
+    bool canAppend(const CANFrameStore &other) const;
+    void swap(CANFrameStore &other);
+
+    // Reorders frames by timestamp; frames with equal timestamps keep their order
+    void sortByTimestamp();
+    bool isTimeOrdered() const;
+
+    // Sets index to the index for an interface name, adding it on first use.
+    // Returns false when the name is new and the table is full.
+    bool internInterface(std::string_view name, uint8_t &index);
+
+    uint64_t timestamp(size_t row) const { return timestampColumn[row]; }
+    uint32_t id(size_t row) const { return idColumn[row]; }
+    uint8_t dlc(size_t row) const { return dlcColumn[row]; }
+    uint8_t flags(size_t row) const { return flagsColumn[row]; }
+    uint8_t interfaceIndex(size_t row) const { return interfaceColumn[row]; }
+    const std::string &interfaceName(size_t row) const { return interfaces[interfaceColumn[row]]; }
+
+    // dlc(row) bytes of payload, contiguous even for long FD frames. Remote
+    // frames keep their requested DLC but their payload is all zeros.
+    const uint8_t *payload(size_t row) const
+    {
+        if (dlcColumn[row] > kPayloadStride) {
+            return fdPayload(row);
+        }
+        return payloadColumn.data() + row * kPayloadStride;
+    }
+
+    // Raw columns, for code that scans the whole store
+    const FrameColumn<uint64_t> &timestamps() const { return timestampColumn; }
+    const FrameColumn<uint32_t> &ids() const { return idColumn; }
+    const FrameColumn<uint8_t> &dlcs() const { return dlcColumn; }
+    const FrameColumn<uint8_t> &flagColumn() const { return flagsColumn; }
+    const FrameColumn<uint8_t> &interfaceIndices() const { return interfaceColumn; }
+    const FrameColumn<uint8_t> &payloads() const { return payloadColumn; }
+    const std::vector<std::string> &interfaceNames() const { return interfaces; }
+
+    // Heap bytes held by the columns; columns used in place from a sidecar
+    // mapping count nothing
+    size_t memoryUsage() const;
+
+private:
+    friend class CANIndexFile;  // bulk (de)serialization of the columns
+
+    const uint8_t *fdPayload(size_t row) const;
+
+    FrameColumn<uint64_t> timestampColumn;
+    FrameColumn<uint32_t> idColumn;
+    FrameColumn<uint8_t> dlcColumn;
+    FrameColumn<uint8_t> flagsColumn;
+    FrameColumn<uint8_t> interfaceColumn;
+    FrameColumn<uint8_t> payloadColumn;  // kPayloadStride bytes per frame, zero padded
+
+    FrameColumn<uint64_t> fdRows;        // rows with more than 8 payload bytes, ascending
+    FrameColumn<uint8_t> fdPayloads;     // 64 bytes per entry in fdRows
+
+    std::vector<std::string> interfaces;
+};
+
+#endif // FRAME_STORE_H
@@ -0,0 +1,151 @@
+#include "hex_decode.h"
+
+#include <bit>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HEX_DECODE_X86 1
+#include <immintrin.h>
+#else
+#define HEX_DECODE_X86 0
+#endif
+
+namespace {
+
+size_t decodeHexRunScalar(const char *text, const char *end, uint8_t *out, size_t maxBytes)
+{
+    size_t written = 0;
+    while (written < maxBytes && end - text >= 2) {
+        uint8_t hi = hexDigitValue(text[0]);
+        uint8_t lo = hexDigitValue(text[1]);
+        if ((hi | lo) & 0xF0) break;  // either nibble invalid
+        out[written++] = static_cast<uint8_t>((hi << 4) | lo);
+        text += 2;
+    }
+    return written;
+}
+
+#if HEX_DECODE_X86
+
+// Both kernels classify every character at once, turn the valid ones into
+// nibbles, and fuse nibble pairs into bytes with one multiply-add:
+// maddubs(nibbles, [16, 1]) gives hi * 16 + lo per 16-bit lane. The length of
+// the leading run of valid characters comes from the movemask.
+
+__attribute__((target("sse4.1")))
+inline __m128i nibblesSSE(__m128i chars, unsigned &validMask)
+{
+    __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    // Unsigned "x <= limit" is min(x, limit) == x
+    __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+    validMask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)));
+    return _mm_blendv_epi8(_mm_add_epi8(letters, _mm_set1_epi8(10)), digits, isDigit);
+}
+
+__attribute__((target("sse4.1")))
+size_t decodeHexRunSSE(const char *text, const char *end, uint8_t *out, size_t maxBytes)
+{
+    size_t written = 0;
+    while (maxBytes - written >= 8 && end - text >= 16) {
+        unsigned validMask;
+        __m128i nibbles = nibblesSSE(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text)), validMask);
+        __m128i pairs = _mm_maddubs_epi16(nibbles, _mm_set1_epi16(0x0110));
+        __m128i bytes = _mm_packus_epi16(pairs, pairs);
+
+        if (validMask == 0xFFFF) {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out + written), bytes);
+            written += 8;
+            text += 16;
+            continue;
+        }
+
+        // The run ends inside this block
+        alignas(16) uint8_t block[16];
+        _mm_store_si128(reinterpret_cast<__m128i *>(block), bytes);
+        size_t count = static_cast<size_t>(std::countr_one(validMask)) / 2;
+        std::memcpy(out + written, block, count);
+        return written + count;
+    }
+    return written + decodeHexRunScalar(text, end, out + written, maxBytes - written);
+}
+
+__attribute__((target("avx2")))
+size_t decodeHexRunAVX2(const char *text, const char *end, uint8_t *out, size_t maxBytes)
+{
+    size_t written = 0;
+    while (maxBytes - written >= 16 && end - text >= 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text));
+        __m256i digits = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+        __m256i letters = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+        __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letters, _mm256_set1_epi8(5)), letters);
+        uint32_t validMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter)));
+        __m256i nibbles = _mm256_blendv_epi8(_mm256_add_epi8(letters, _mm256_set1_epi8(10)), digits, isDigit);
+
+        __m256i pairs = _mm256_maddubs_epi16(nibbles, _mm256_set1_epi16(0x0110));
+        // packus works per 128-bit lane, gather the two 8-byte halves together
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs, pairs), 0x08);
+        __m128i bytes = _mm256_castsi256_si128(packed);
+
+        if (validMask == 0xFFFFFFFFU) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + written), bytes);
+            written += 16;
+            text += 32;
+            continue;
+        }
+
+        alignas(16) uint8_t block[16];
+        _mm_store_si128(reinterpret_cast<__m128i *>(block), bytes);
+        size_t count = static_cast<size_t>(std::countr_one(validMask)) / 2;
+        std::memcpy(out + written, block, count);
+        return written + count;
+    }
+    // Classic 8-byte payloads never fill an AVX2 block. The SSE kernel uses
+    // legacy encodings, which stall on dirty upper halves left by an earlier
+    // FD payload unless they are cleared first.
+    _mm256_zeroupper();
+    return written + decodeHexRunSSE(text, end, out + written, maxBytes - written);
+}
+
+#endif // HEX_DECODE_X86
+
+using DecodeFn = size_t (*)(const char *, const char *, uint8_t *, size_t);
+
+struct HexKernel {
+    DecodeFn decode;
+    const char *name;
+};
+
+HexKernel selectKernel()
+{
+#if HEX_DECODE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {decodeHexRunAVX2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return {decodeHexRunSSE, "sse4.1"};
+    }
+#endif
+    return {decodeHexRunScalar, "scalar"};
+}
+
+const HexKernel &kernel()
+{
+    static const HexKernel selected = selectKernel();
+    return selected;
+}
+
+} // namespace
+
+size_t decodeHexRun(const char *text, const char *end, uint8_t *out, size_t maxBytes)
+{
+    return kernel().decode(text, end, out, maxBytes);
+}
+
+const char *hexDecoderName()
+{
+    return kernel().name;
+}
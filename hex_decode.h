@@ -0,0 +1,41 @@
+#ifndef HEX_DECODE_H
+#define HEX_DECODE_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Hex text to binary kernels used by the log parsers. The implementation is
+// picked once at startup: AVX2, SSE4.1 or a portable scalar loop.
+
+// Decodes the run of hex digit pairs starting at text into out. Stops at the
+// first character that is not a hex digit, at end, or once maxBytes bytes were
+// written, and returns the number of bytes written. An odd trailing digit is
+// left unconsumed for the caller to reject.
+size_t decodeHexRun(const char *text, const char *end, uint8_t *out, size_t maxBytes);
+
+// Name of the kernel selected for this CPU ("avx2", "sse4.1" or "scalar")
+const char *hexDecoderName();
+
+// Digit values for every byte, 0xFF for anything that is not a hex digit
+struct HexDigitTable {
+    uint8_t value[256];
+    constexpr HexDigitTable() : value() {
+        for (int i = 0; i < 256; ++i) value[i] = 0xFF;
+        for (int i = 0; i < 10; ++i) value['0' + i] = static_cast<uint8_t>(i);
+        for (int i = 0; i < 6; ++i) {
+            value['a' + i] = static_cast<uint8_t>(10 + i);
+            value['A' + i] = static_cast<uint8_t>(10 + i);
+        }
+    }
+};
+
+inline constexpr HexDigitTable kHexDigits;
+
+// Value of a single hex digit, or 0xFF if c is not one
+inline uint8_t hexDigitValue(char c)
+{
+    return kHexDigits.value[static_cast<unsigned char>(c)];
+}
+
+#endif // HEX_DECODE_H
@@ -0,0 +1,99 @@
+#include "live_capture.h"
+
+#include <QThread>
+#include <QTimer>
+
+#include <cstring>
+
+namespace {
+// Frames moved out of the ring per pop
+constexpr size_t kDrainBatch = 4096;
+}
+
+LiveCapture::LiveCapture(QObject *parent)
+    : QObject(parent)
+    , drainTimer(new QTimer(this))
+{
+    drainTimer->setInterval(kDrainMs);
+    connect(drainTimer, &QTimer::timeout, this, &LiveCapture::drain);
+}
+
+LiveCapture::~LiveCapture()
+{
+    stop();
+}
+
+void LiveCapture::start(std::unique_ptr<LiveReader> newReader)
+{
+    stop();
+    reader = std::move(newReader);
+    feed = std::make_unique<LiveFeed>(kRingFrames);
+    drainBuffer.resize(kDrainBatch);
+    stopRequested = false;
+
+    LiveReader *source = reader.get();
+    LiveFeed *sink = feed.get();
+    worker = QThread::create([this, source, sink]() {
+        source->run(*sink, stopRequested);
+    });
+    connect(worker, &QThread::finished, this, [this, thread = worker]() {
+        if (worker == thread && !stopRequested) {
+            emit sourceClosed();
+        }
+    });
+    // Reading must keep up with the bus whatever the GUI is doing
+    worker->start(QThread::TimeCriticalPriority);
+    drainTimer->start();
+}
+
+void LiveCapture::stop()
+{
+    if (!worker) {
+        return;
+    }
+    stopRequested = true;
+    worker->wait();
+    delete worker;
+    worker = nullptr;
+    drainTimer->stop();
+
+    drain();
+    lastCounters = feed->counters();
+    feed.reset();
+    reader.reset();
+}
+
+LiveCaptureCounters LiveCapture::counters() const
+{
+    return feed ? feed->counters() : lastCounters;
+}
+
+void LiveCapture::drain()
+{
+    const std::vector<std::string> &names = reader->interfaces();
+    auto chunk = std::make_shared<CANFrameStore>();
+    size_t count;
+    while ((count = feed->drain(drainBuffer.data(), drainBuffer.size())) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            const LiveFrame &live = drainBuffer[i];
+            CANFrame frame;
+            frame.timestampNs = live.timestampNs;
+            frame.id = live.id;
+            frame.dlc = live.dlc;
+            frame.flags = live.flags;
+            std::memcpy(frame.data, live.data, sizeof(frame.data));
+            frame.interfaceName = names[live.interface];
+            chunk->append(frame);
+        }
+    }
+    if (chunk->empty()) {
+        return;
+    }
+
+    // Each interface is read in order, but the interleaving between them is
+    // only as good as the reader's poll loop
+    if (!chunk->isTimeOrdered()) {
+        chunk->sortByTimestamp();
+    }
+    emit framesReady(chunk);
+}
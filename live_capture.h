@@ -0,0 +1,151 @@
+#ifndef LIVE_CAPTURE_H
+#define LIVE_CAPTURE_H
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "frame_store.h"
+#include "spsc_ring.h"
+
+class QThread;
+class QTimer;
+
+// One frame as read off a live bus, before it reaches the frame store
+struct LiveFrame {
+    uint64_t timestampNs = 0;
+    uint32_t id = 0;
+    uint8_t dlc = 0;
+    uint8_t flags = 0;      // CANFrameFlags
+    uint8_t interface = 0;  // index into LiveReader::interfaces()
+    uint8_t data[64];
+};
+
+struct LiveCaptureCounters {
+    uint64_t received = 0;       // frames read off the bus
+    uint64_t ringOverflows = 0;  // frames dropped because the GUI fell behind the reader
+    uint64_t kernelDrops = 0;    // frames the OS dropped before the reader got to them
+    uint64_t readErrors = 0;     // failed reads, e.g. an interface that went down
+
+    // Network sources only
+    uint64_t packetsLost = 0;       // sequence numbers never seen
+    uint64_t packetsReordered = 0;  // packets that arrived after a later one
+    uint64_t packetsMalformed = 0;  // packets or messages that could not be decoded
+    uint64_t connectionsClosed = 0; // connections the server closed or that failed
+};
+
+// Hand-off from a reader thread to the GUI thread. The reader pushes into a
+// lock-free ring and never waits; when the ring is full the frame is counted
+// and dropped, so a busy GUI can cost frames but never stalls the reader.
+class LiveFeed
+{
+public:
+    explicit LiveFeed(size_t capacity) : ring(capacity) {}
+
+    // Reader thread
+    void push(const LiveFrame &frame)
+    {
+        received.fetch_add(1, std::memory_order_relaxed);
+        if (!ring.push(frame)) {
+            ringOverflows.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void addKernelDrops(uint64_t frames) { kernelDrops.fetch_add(frames, std::memory_order_relaxed); }
+    void addReadError() { readErrors.fetch_add(1, std::memory_order_relaxed); }
+    void addClosedConnection() { connectionsClosed.fetch_add(1, std::memory_order_relaxed); }
+    void setPacketCounts(uint64_t lost, uint64_t reordered, uint64_t malformed)
+    {
+        packetsLost.store(lost, std::memory_order_relaxed);
+        packetsReordered.store(reordered, std::memory_order_relaxed);
+        packetsMalformed.store(malformed, std::memory_order_relaxed);
+    }
+
+    // GUI thread
+    size_t drain(LiveFrame *out, size_t maxFrames) { return ring.pop(out, maxFrames); }
+    size_t capacity() const { return ring.capacity(); }
+
+    LiveCaptureCounters counters() const
+    {
+        LiveCaptureCounters counters;
+        counters.received = received.load(std::memory_order_relaxed);
+        counters.ringOverflows = ringOverflows.load(std::memory_order_relaxed);
+        counters.kernelDrops = kernelDrops.load(std::memory_order_relaxed);
+        counters.readErrors = readErrors.load(std::memory_order_relaxed);
+        counters.packetsLost = packetsLost.load(std::memory_order_relaxed);
+        counters.packetsReordered = packetsReordered.load(std::memory_order_relaxed);
+        counters.packetsMalformed = packetsMalformed.load(std::memory_order_relaxed);
+        counters.connectionsClosed = connectionsClosed.load(std::memory_order_relaxed);
+        return counters;
+    }
+
+private:
+    SpscRing<LiveFrame> ring;
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> ringOverflows{0};
+    std::atomic<uint64_t> kernelDrops{0};
+    std::atomic<uint64_t> readErrors{0};
+    std::atomic<uint64_t> packetsLost{0};
+    std::atomic<uint64_t> packetsReordered{0};
+    std::atomic<uint64_t> packetsMalformed{0};
+    std::atomic<uint64_t> connectionsClosed{0};
+};
+
+// A source of live frames, opened on the GUI thread and then run on the
+// capture thread until asked to stop
+class LiveReader
+{
+public:
+    virtual ~LiveReader() = default;
+
+    // Names of the interfaces LiveFrame::interface refers to
+    virtual const std::vector<std::string> &interfaces() const = 0;
+
+    // Reads into feed until stop is set; must notice stop within about 100 ms.
+    // May return earlier when the source is gone for good.
+    virtual void run(LiveFeed &feed, const std::atomic<bool> &stop) = 0;
+};
+
+// Runs a LiveReader on its own thread and moves what it reads into frame
+// store chunks on the GUI thread every kDrainMs, delivered like LogLoader's.
+class LiveCapture : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr size_t kRingFrames = 1 << 16;
+    static constexpr int kDrainMs = 16;
+
+    explicit LiveCapture(QObject *parent = nullptr);
+    ~LiveCapture();
+
+    // Starts reading from reader, stopping any capture already running
+    void start(std::unique_ptr<LiveReader> reader);
+
+    // Stops the reader thread and delivers the frames still in the ring
+    void stop();
+
+    bool isRunning() const { return worker != nullptr; }
+    LiveCaptureCounters counters() const;
+
+signals:
+    void framesReady(std::shared_ptr<CANFrameStore> chunk);
+    void sourceClosed();  // the reader returned without being stopped
+
+private:
+    void drain();
+
+    std::unique_ptr<LiveReader> reader;
+    std::unique_ptr<LiveFeed> feed;
+    std::vector<LiveFrame> drainBuffer;
+    LiveCaptureCounters lastCounters;  // of the last capture, once stopped
+    std::atomic<bool> stopRequested{false};
+    QThread *worker = nullptr;
+    QTimer *drainTimer;
+};
+
+#endif // LIVE_CAPTURE_H
@@ -0,0 +1,444 @@
+#include "log_loader.h"
+#include "can_log_parser.h"
+#include "can_csv_parser.h"
+#include "can_index_file.h"
+#include "can_record_file.h"
+#include "mapped_file.h"
+
+#include <QMetaObject>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+// Byte ranges handed to the parse threads. A small first piece lets the
+// table show something right away, larger ones keep per-piece GUI work low
+constexpr size_t kFirstPieceBytes = 256 * 1024;
+constexpr size_t kMaxPieceBytes = 16 * 1024 * 1024;
+
+// How many pieces the workers may run ahead of the one being published
+constexpr size_t kPiecesAheadPerThread = 4;
+
+// Frames per chunk of a binary recording, which is read front to back
+constexpr size_t kRecordingChunkFrames = 1 << 20;
+
+// A newline-aligned slice of the mapped log and the frames parsed from it
+struct LogPiece {
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    std::shared_ptr<CANFrameStore> frames;
+    size_t malformed = 0;
+    bool tooManyInterfaces = false;
+    bool done = false;
+};
+
+QString tooManyInterfacesMessage()
+{
+    return QString("The file uses more than %1 interface names, which cannot be told apart.")
+        .arg(CANFrameStore::kMaxInterfaces);
+}
+
+// Flips inQuotes once for every '"' in [p, end). Doubled quotes inside a
+// quoted field flip it twice and so leave it unchanged.
+void trackQuotes(const char *p, const char *end, bool &inQuotes)
+{
+    while (p < end && (p = static_cast<const char *>(std::memchr(p, '"', static_cast<size_t>(end - p))))) {
+        inQuotes = !inQuotes;
+        ++p;
+    }
+}
+
+// With quotedFields, a newline only ends a piece outside a quoted field.
+// Quotes are counted from the start of the data, so CSV splitting reads
+// every byte once; files without quotes pass through memchr at full speed.
+std::vector<LogPiece> splitLog(const char *begin, const char *end, bool quotedFields)
+{
+    std::vector<LogPiece> pieces;
+    size_t pieceBytes = kFirstPieceBytes;
+    const char *cursor = begin;
+
+    while (cursor < end) {
+        const char *pieceEnd = end;
+        if (static_cast<size_t>(end - cursor) > pieceBytes) {
+            const char *scanned = cursor;
+            const char *search = cursor + pieceBytes;
+            bool inQuotes = false;
+            for (;;) {
+                const char *newline = static_cast<const char *>(
+                    std::memchr(search, '\n', static_cast<size_t>(end - search)));
+                if (!newline) {
+                    break;
+                }
+                if (quotedFields) {
+                    trackQuotes(scanned, newline, inQuotes);
+                    scanned = newline;
+                }
+                if (!inQuotes) {
+                    pieceEnd = newline + 1;
+                    break;
+                }
+                search = newline + 1;
+            }
+        }
+        LogPiece piece;
+        piece.begin = cursor;
+        piece.end = pieceEnd;
+        pieces.push_back(piece);
+
+        cursor = pieceEnd;
+        pieceBytes = std::min(pieceBytes * 2, kMaxPieceBytes);
+    }
+    return pieces;
+}
+}
+
+LogLoader::LogLoader(QObject *parent)
+    : QObject(parent)
+{
+}
+
+LogLoader::~LogLoader()
+{
+    cancel();
+}
+
+void LogLoader::start(const QString &filePath)
+{
+    cancel();
+    cancelRequested = false;
+    currentPath = filePath;
+
+    quint64 generation = currentGeneration;
+    worker = QThread::create([this, filePath, generation]() {
+        run(filePath, generation);
+    });
+    worker->start();
+}
+
+void LogLoader::cancel()
+{
+    if (sidecarWriter) {
+        sidecarCancel = true;
+        sidecarWriter->wait();
+        delete sidecarWriter;
+        sidecarWriter = nullptr;
+    }
+    if (worker) {
+        cancelRequested = true;
+        worker->wait();
+        delete worker;
+        worker = nullptr;
+    }
+    // Anything the old worker queued up is now stale
+    ++currentGeneration;
+}
+
+void LogLoader::setThreadCount(int threads)
+{
+    threadCount = threads;
+}
+
+int LogLoader::effectiveThreadCount() const
+{
+    return threadCount > 0 ? threadCount : std::max(1, QThread::idealThreadCount());
+}
+
+void LogLoader::setSidecarEnabled(bool enabled)
+{
+    sidecarEnabled = enabled;
+}
+
+void LogLoader::saveSidecar(const CANFrameStore *store)
+{
+    if (!sidecarEnabled || currentPath.isEmpty() || sidecarWriter) {
+        return;
+    }
+    sidecarCancel = false;
+    QString path = currentPath;
+    sidecarWriter = QThread::create([this, path, store]() {
+        CANIndexFile::save(path, *store, sidecarCancel);
+    });
+    sidecarWriter->start(QThread::LowPriority);
+}
+
+bool LogLoader::isRunning() const
+{
+    return worker && worker->isRunning();
+}
+
+template <typename Fn>
+void LogLoader::post(quint64 generation, Fn &&fn)
+{
+    QMetaObject::invokeMethod(this, [this, generation, fn = std::forward<Fn>(fn)]() {
+        if (generation == currentGeneration) {
+            fn();
+        }
+    }, Qt::QueuedConnection);
+}
+
+void LogLoader::run(const QString &filePath, quint64 generation)
+{
+    // A matching sidecar turns the whole load into a few bulk copies
+    if (sidecarEnabled) {
+        auto frames = std::make_shared<CANFrameStore>();
+        if (CANIndexFile::load(filePath, *frames)) {
+            qint64 bytesTotal = CANIndexFile::sourceKey(filePath).size;
+            post(generation, [this, frames, bytesTotal]() {
+                emit framesReady(frames);
+                emit progress(bytesTotal, bytesTotal);
+                emit finished(0, true);
+            });
+            return;
+        }
+    }
+
+    if (filePath.endsWith(".csv", Qt::CaseInsensitive)) {
+        parseCSV(filePath, generation);
+    } else if (filePath.endsWith(".canrec", Qt::CaseInsensitive)) {
+        parseRecording(filePath, generation);
+    } else {
+        parseLog(filePath, generation);
+    }
+}
+
+void LogLoader::parseLog(const QString &filePath, quint64 generation)
+{
+    MappedFile file;
+    if (!file.open(filePath)) {
+        QString message = QString("Unable to open the LOG file: %1").arg(file.errorString());
+        post(generation, [this, message]() { emit failed(message); });
+        return;
+    }
+
+    parseParallel(file, file.begin(), generation, false, [](const char *begin, const char *end) {
+        return CANLogParser(begin, end);
+    });
+}
+
+void LogLoader::parseCSV(const QString &filePath, quint64 generation)
+{
+    MappedFile file;
+    if (!file.open(filePath)) {
+        QString message = QString("Unable to open the CSV file: %1").arg(file.errorString());
+        post(generation, [this, message]() { emit failed(message); });
+        return;
+    }
+
+    // The header decides the column mapping for every piece
+    const char *firstLineEnd = file.size() > 0
+        ? static_cast<const char *>(std::memchr(file.begin(), '\n', static_cast<size_t>(file.size())))
+        : nullptr;
+    if (!firstLineEnd) {
+        firstLineEnd = file.end();
+    }
+    int headerLines = 0;
+    CSVSchema schema = CANCSVParser::detectSchema(
+        std::string_view(file.begin(), static_cast<size_t>(firstLineEnd - file.begin())), headerLines);
+    if (!schema.isValid()) {
+        QString message = "Could not find timestamp, ID and data columns in the CSV file.";
+        post(generation, [this, message]() { emit failed(message); });
+        return;
+    }
+
+    const char *dataBegin = headerLines > 0 ? std::min(firstLineEnd + 1, file.end()) : file.begin();
+    // Quoted CSV fields may span lines, so pieces are only cut between records
+    parseParallel(file, dataBegin, generation, true, [&schema](const char *begin, const char *end) {
+        return CANCSVParser(begin, end, schema);
+    });
+}
+
+void LogLoader::parseRecording(const QString &filePath, quint64 generation)
+{
+    MappedFile file;
+    if (!file.open(filePath)) {
+        QString message = QString("Unable to open the recording: %1").arg(file.errorString());
+        post(generation, [this, message]() { emit failed(message); });
+        return;
+    }
+    if (!CANRecordFile::hasHeader(file.begin(), file.end())) {
+        QString message = "The file is not a CANvis recording or was written by a newer version.";
+        post(generation, [this, message]() { emit failed(message); });
+        return;
+    }
+
+    // Records vary in length and cannot be split up, so one thread reads them
+    CANRecordParser parser(file.begin(), file.end());
+    qint64 bytesTotal = file.size();
+    bool overlapping = false;
+    uint64_t lastTimestamp = 0;
+    CANFrame frame;
+    bool more = true;
+    while (more) {
+        auto frames = std::make_shared<CANFrameStore>();
+        frames->reserve(kRecordingChunkFrames);
+        while (frames->size() < kRecordingChunkFrames && (more = parser.next(frame))) {
+            if (!frames->append(frame)) {
+                QString message = tooManyInterfacesMessage();
+                post(generation, [this, message]() { emit failed(message); });
+                return;
+            }
+        }
+        if (cancelRequested) {
+            return;
+        }
+        if (frames->empty()) {
+            continue;
+        }
+
+        if (frames->timestamp(0) < lastTimestamp || !frames->isTimeOrdered()) {
+            overlapping = true;
+        }
+        lastTimestamp = frames->timestamp(frames->size() - 1);
+        qint64 bytesParsed = static_cast<qint64>(parser.bytesConsumed());
+        post(generation, [this, frames, bytesParsed, bytesTotal]() {
+            emit framesReady(frames);
+            emit progress(bytesParsed, bytesTotal);
+        });
+    }
+
+    size_t malformed = parser.malformedRecords();
+    post(generation, [this, malformed, overlapping]() {
+        if (overlapping) {
+            emit needsTimeOrdering();
+        }
+        emit finished(malformed, false);
+    });
+}
+
+template <typename ParserFactory>
+void LogLoader::parseParallel(const MappedFile &file, const char *dataBegin, quint64 generation,
+                              bool quotedFields,
+                              ParserFactory makeParser)
+{
+    // The file is cut into newline-aligned pieces which a pool of threads
+    // parses concurrently. This thread hands finished pieces to the GUI in
+    // file order, so the table still fills in from the top.
+    std::vector<LogPiece> pieces = splitLog(dataBegin, file.end(), quotedFields);
+    qint64 bytesTotal = file.size();
+    size_t threads = std::min<size_t>(static_cast<size_t>(effectiveThreadCount()), pieces.size());
+    size_t aheadLimit = threads * kPiecesAheadPerThread;
+
+    std::mutex mutex;
+    std::condition_variable pieceDone;
+    std::condition_variable pieceTaken;
+    size_t nextPiece = 0;
+    size_t published = 0;
+
+    auto parsePieces = [&]() {
+        for (;;) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // Do not run too far ahead of the publisher, unpublished pieces cost memory
+                while (!cancelRequested && nextPiece < pieces.size() && nextPiece >= published + aheadLimit) {
+                    pieceTaken.wait_for(lock, std::chrono::milliseconds(50));
+                }
+                if (cancelRequested || nextPiece >= pieces.size()) {
+                    return;
+                }
+                index = nextPiece++;
+            }
+
+            LogPiece &piece = pieces[index];
+            auto frames = std::make_shared<CANFrameStore>();
+            // candump lines average around 40 bytes, CSV records are longer
+            frames->reserve(static_cast<size_t>(piece.end - piece.begin) / 40);
+
+            auto parser = makeParser(piece.begin, piece.end);
+            CANFrame frame;
+            size_t parsed = 0;
+            bool tooManyInterfaces = false;
+            while (parser.next(frame)) {
+                if (!frames->append(frame)) {
+                    tooManyInterfaces = true;
+                    break;
+                }
+                if ((++parsed & 0xFFFF) == 0 && cancelRequested) {
+                    return;
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                piece.frames = std::move(frames);
+                piece.malformed = parser.malformedLines();
+                piece.tooManyInterfaces = tooManyInterfaces;
+                piece.done = true;
+            }
+            pieceDone.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        pool.emplace_back(parsePieces);
+    }
+
+    size_t malformed = 0;
+    bool overlapping = false;
+    uint64_t lastTimestamp = 0;
+
+    while (published < pieces.size()) {
+        std::shared_ptr<CANFrameStore> frames;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!cancelRequested && !pieces[published].done) {
+                pieceDone.wait_for(lock, std::chrono::milliseconds(50));
+            }
+            if (cancelRequested) {
+                break;
+            }
+            if (pieces[published].tooManyInterfaces) {
+                // Fail the whole load, the remaining workers stop as if cancelled
+                QString message = tooManyInterfacesMessage();
+                post(generation, [this, message]() { emit failed(message); });
+                cancelRequested = true;
+                break;
+            }
+            frames = std::move(pieces[published].frames);
+            malformed += pieces[published].malformed;
+            ++published;
+        }
+        pieceTaken.notify_all();
+
+        if (frames->empty()) {
+            continue;
+        }
+
+        // A piece out of order within itself, or starting before the previous
+        // one ended, means the file is not in time order; the GUI re-sorts
+        // once loading is done
+        if (frames->timestamp(0) < lastTimestamp || !frames->isTimeOrdered()) {
+            overlapping = true;
+        }
+        lastTimestamp = frames->timestamp(frames->size() - 1);
+
+        qint64 bytesParsed = static_cast<qint64>(pieces[published - 1].end - file.begin());
+        post(generation, [this, frames, bytesParsed, bytesTotal]() {
+            emit framesReady(frames);
+            emit progress(bytesParsed, bytesTotal);
+        });
+    }
+
+    pieceTaken.notify_all();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    if (cancelRequested) {
+        return;
+    }
+
+    post(generation, [this, malformed, overlapping]() {
+        if (overlapping) {
+            emit needsTimeOrdering();
+        }
+        emit finished(malformed, false);
+    });
+}
@@ -0,0 +1,79 @@
+#ifndef LOG_LOADER_H
+#define LOG_LOADER_H
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include "frame_store.h"
+
+class QThread;
+class MappedFile;
+
+// Parses a log file on a worker thread and hands the frames to the GUI thread
+// in chunks, so the table can fill in while the rest of the file is read.
+// All signals are delivered on the thread that owns the loader.
+class LogLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LogLoader(QObject *parent = nullptr);
+    ~LogLoader();
+
+    // Starts loading filePath, cancelling any load already in progress
+    void start(const QString &filePath);
+
+    // Asks the worker to stop and waits for it; no further signals are emitted
+    // for the cancelled load.
+    void cancel();
+
+    bool isRunning() const;
+
+    // Number of threads used to parse .log files; 0 picks one per core
+    void setThreadCount(int threads);
+    int effectiveThreadCount() const;
+
+    // Whether loads try the .canidx sidecar first and parsed logs get one written
+    void setSidecarEnabled(bool enabled);
+
+    // Writes the sidecar for the file that was just parsed, on a background
+    // thread. store must stay untouched until cancel() or the next start().
+    void saveSidecar(const CANFrameStore *store);
+
+signals:
+    void framesReady(std::shared_ptr<CANFrameStore> chunk);
+    void progress(qint64 bytesParsed, qint64 bytesTotal);
+    void needsTimeOrdering();  // pieces overlapped in time, sort before use
+    void finished(size_t malformedLines, bool fromSidecar);
+    void failed(const QString &message);
+
+private:
+    void run(const QString &filePath, quint64 generation);
+    void parseLog(const QString &filePath, quint64 generation);
+    void parseCSV(const QString &filePath, quint64 generation);
+    void parseRecording(const QString &filePath, quint64 generation);
+
+    // Splits [dataBegin, end of file) into pieces parsed concurrently by the
+    // parsers makeParser(begin, end) returns, publishing frames in file order.
+    // With quotedFields, newlines inside double quotes do not end a piece.
+    template <typename ParserFactory>
+    void parseParallel(const MappedFile &file, const char *dataBegin, quint64 generation,
+                       bool quotedFields, ParserFactory makeParser);
+
+    // Queue a call onto the loader's thread, dropped if the load was superseded
+    template <typename Fn>
+    void post(quint64 generation, Fn &&fn);
+
+    QThread *worker = nullptr;
+    QThread *sidecarWriter = nullptr;
+    QString currentPath;
+    int threadCount = 0;
+    bool sidecarEnabled = true;
+    std::atomic<bool> sidecarCancel{false};
+    std::atomic<bool> cancelRequested{false};
+    std::atomic<quint64> currentGeneration{0};
+};
+
+#endif // LOG_LOADER_H
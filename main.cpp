@@ -1,10 +1,50 @@
 #include "mainwindow.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <algorithm>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption threadsOption("threads", "Number of threads used to parse log files (0 = one per core).",
+                                     "count", "0");
+    parser.addOption(threadsOption);
+    QCommandLineOption noIndexCacheOption("no-index-cache", "Do not read or write .canidx sidecar files next to logs.");
+    parser.addOption(noIndexCacheOption);
+    QCommandLineOption decodeCacheOption("decode-cache-mb", "Memory kept for decoded DBC signals of table rows, in MiB.",
+                                         "size", "64");
+    parser.addOption(decodeCacheOption);
+    QCommandLineOption captureOption("capture", "Start capturing from SocketCAN interfaces, comma separated (e.g. vcan0), "
+                                     "cannelloni://[address][:port] or socketcand://host[:port]/can0,can1.",
+                                     "source");
+    parser.addOption(captureOption);
+    QCommandLineOption recordOption("record", "Record captured frames to this .log or .canrec file.", "file");
+    parser.addOption(recordOption);
+    QCommandLineOption recordFilterOption("record-filter", "Only record frames matching this filter expression.",
+                                          "expression");
+    parser.addOption(recordFilterOption);
+    QCommandLineOption rotateSizeOption("record-rotate-mb", "Start a new recording file after this many MiB (0 = never).",
+                                        "size", "0");
+    parser.addOption(rotateSizeOption);
+    QCommandLineOption rotateTimeOption("record-rotate-s", "Start a new recording file after this many seconds (0 = never).",
+                                        "seconds", "0");
+    parser.addOption(rotateTimeOption);
+    parser.process(a);
+
     MainWindow w;
+    w.setParseThreadCount(parser.value(threadsOption).toInt());
+    w.setIndexCacheEnabled(!parser.isSet(noIndexCacheOption));
+    w.setDecodeCacheBudget(static_cast<size_t>(std::max(1, parser.value(decodeCacheOption).toInt())) * 1024 * 1024);
+    w.setRecordRotation(parser.value(rotateSizeOption).toLongLong() * 1024 * 1024, parser.value(rotateTimeOption).toLongLong());
     w.show();
+    if (parser.isSet(captureOption)) {
+        w.startCapture(parser.value(captureOption));
+    }
+    if (parser.isSet(recordOption)) {
+        w.startRecording(parser.value(recordOption), parser.value(recordFilterOption));
+    }
     return a.exec();
 }
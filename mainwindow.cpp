@@ -1,10 +1,22 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
-#include "libs/can-utils/dbc/dbc_parser.h"
-#include "dbc_handler.h"
+#include "can_log_parser.h"
+#include "frame_format.h"
+#include "can_frame_model.h"
+#include "can_frame_filter_model.h"
+#include "filter_expression.h"
+#include "payload_search.h"
+#include "bus_statistics_model.h"
+#include "bus_state_model.h"
+#include "log_loader.h"
+#include "live_capture.h"
+#include "socketcan_reader.h"
+#include "network_reader.h"
+#include "frame_recorder.h"
+#include "scrub_bar.h"
+#include "batch_signal_decoder.h"
+#include "signal_plot_view.h"
 
-#include <QFile>
-#include <QTextStream>
 #include <QRegularExpression>
 #include <QMessageBox>
 #include <QTimer>
@@ -12,6 +24,13 @@
 #include <QThread>
 #include <QElapsedTimer>
 #include <QLabel>
+#include <QSet>
+#include <QSignalBlocker>
+#include <QInputDialog>
+#include <QFileInfo>
+#include <QShortcut>
+#include <QUrl>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -19,10 +38,87 @@ MainWindow::MainWindow(QWidget *parent)
     , playTimer(new QTimer(this))
     , currentRow(0)
     , isPlaying(false)
-    , playbackSpeed(1) 
 {
     ui->setupUi(this);
 
+    // The frame table is a virtual view over the frame store, filtered
+    // through a row list taken from the ID index
+    frameModel = new CANFrameModel(&frameStore, this);
+    filterModel = new CANFrameFilterModel(this);
+    filterModel->setSourceModel(frameModel);
+    ui->tableCANData->setModel(filterModel);
+    ui->lineEditFilterID->setPlaceholderText("ID, or e.g. id & 0x7F0 == 0x100 && data[0] > 10");
+    ui->tableCANData->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->tableCANData->verticalHeader()->setDefaultSectionSize(24);
+    ui->tableCANData->setSelectionBehavior(QAbstractItemView::SelectRows);
+    // Decoded columns appear once a DBC is loaded
+    ui->tableCANData->setColumnHidden(CANFrameModel::ColumnMessage, true);
+    ui->tableCANData->setColumnHidden(CANFrameModel::ColumnSignals, true);
+
+    // Traffic statistics, refreshed while their tab is on screen
+    statisticsModel = new BusStatisticsModel(this);
+    ui->tableStatistics->setModel(statisticsModel);
+    ui->tableStatistics->sortByColumn(BusStatisticsModel::ColumnID, Qt::AscendingOrder);
+    ui->tableStatistics->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    ui->tableStatistics->setSelectionBehavior(QAbstractItemView::SelectRows);
+    // The bus state at the shown frame, likewise only rebuilt while on screen
+    busStateModel = new BusStateModel(&frameStore, this);
+    ui->tableBusState->setModel(busStateModel);
+    ui->tableBusState->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    ui->tableBusState->setSelectionBehavior(QAbstractItemView::SelectRows);
+    connect(ui->Tabs, &QTabWidget::currentChanged, this, [this]() {
+        if (statisticsStale && ui->Tabs->currentWidget() == ui->Tab3Statistics)
+        {
+            refreshStatistics();
+        }
+        if (plotStale && ui->Tabs->currentWidget() == ui->Tab4Plot)
+        {
+            extendPlot();
+        }
+        if (busStateStale && ui->Tabs->currentWidget() == ui->Tab5State)
+        {
+            refreshBusState();
+        }
+    });
+
+    // Signal plots draw from a min/max pyramid, never from every sample
+    connect(ui->comboPlotID, &QComboBox::currentIndexChanged, this, &MainWindow::populatePlotSignals);
+    connect(ui->comboPlotSignal, &QComboBox::currentIndexChanged, this, &MainWindow::rebuildPlot);
+    connect(ui->btnPlotResetZoom, &QPushButton::clicked, ui->plotView, &SignalPlotView::resetZoom);
+    ui->plotView->setPyramid(&plotPyramid, QString());
+
+    // Log files are parsed in the background and streamed into the store
+    logLoader = new LogLoader(this);
+    connect(logLoader, &LogLoader::framesReady, this, &MainWindow::appendFrames);
+    connect(logLoader, &LogLoader::progress, this, &MainWindow::updateLoadProgress);
+    connect(logLoader, &LogLoader::needsTimeOrdering, this, &MainWindow::sortFramesByTime);
+    connect(logLoader, &LogLoader::finished, this, &MainWindow::loadFinished);
+    connect(logLoader, &LogLoader::failed, this, &MainWindow::loadFailed);
+    ui->btnCancelLoad->setEnabled(false);
+
+    // Frame count and memory held by the loaded frames, kept in the status bar.
+    // The decode cache fills as the table paints, so it is also polled.
+    memoryLabel = new QLabel(this);
+    ui->statusbar->addPermanentWidget(memoryLabel);
+    updateMemoryLabel();
+    QTimer *memoryTimer = new QTimer(this);
+    connect(memoryTimer, &QTimer::timeout, this, &MainWindow::updateMemoryLabel);
+    memoryTimer->start(1000);
+
+    // Live interfaces arrive the same way, in chunks drained from the capture ring.
+    // The recorder queues its copy first: appendFrames() may take the chunk over.
+    liveCapture = new LiveCapture(this);
+    recorder = new FrameRecorder(this);
+    connect(liveCapture, &LiveCapture::framesReady, this, [this](std::shared_ptr<CANFrameStore> chunk) {
+        recorder->write(*chunk);
+    });
+    connect(liveCapture, &LiveCapture::framesReady, this, &MainWindow::appendFrames);
+    connect(liveCapture, &LiveCapture::framesReady, this, &MainWindow::showCaptureStatus);
+    connect(liveCapture, &LiveCapture::sourceClosed, this, &MainWindow::captureSourceClosed);
+    connect(ui->btnLiveCapture, &QPushButton::clicked, this, &MainWindow::toggleLiveCapture);
+    connect(ui->btnRecord, &QPushButton::clicked, this, &MainWindow::toggleRecording);
+    connect(recorder, &FrameRecorder::failed, this, &MainWindow::recordingFailed);
+
     // Connect buttons to their respective slots
     connect(ui->btnLoadFile, &QPushButton::clicked, this, &MainWindow::on_btnLoadFile_clicked);
     connect(ui->btnApplyFilter, &QPushButton::clicked, this, &MainWindow::on_btnApplyFilter_clicked);
@@ -30,11 +126,26 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->btnPlay_2, &QPushButton::clicked, this, &MainWindow::on_btnPlay_2_clicked);
     connect(ui->btnFF, &QPushButton::clicked, this, &MainWindow::on_btnFF_clicked);
     connect(ui->btnFF_2, &QPushButton::clicked, this, &MainWindow::on_btnFF_2_clicked);
+    connect(ui->btnReverse, &QPushButton::toggled, this, &MainWindow::setReversePlayback);
+    connect(ui->btnReverse_2, &QPushButton::toggled, this, &MainWindow::setReversePlayback);
     connect(ui->btnLoadDBC, &QPushButton::clicked, this, &MainWindow::on_btnLoadDBC_clicked);
+    connect(ui->btnCancelLoad, &QPushButton::clicked, this, &MainWindow::cancelLoad);
+    connect(ui->progressBar, &ScrubBar::scrubbed, this, &MainWindow::seekToFraction);
+    connect(ui->progressBar_2, &ScrubBar::scrubbed, this, &MainWindow::seekToFraction);
+    connect(ui->btnSearchNext, &QPushButton::clicked, this, &MainWindow::searchNext);
+    connect(ui->btnSearchPrev, &QPushButton::clicked, this, &MainWindow::searchPrevious);
+    connect(ui->lineEditSearch, &QLineEdit::returnPressed, this, &MainWindow::searchNext);
     connect(playTimer, &QTimer::timeout, this, &MainWindow::updateTableRow);
     
-    // Set timer interval (100ms for smooth updates)
-    playTimer->setInterval(100);
+    // Each tick plays every frame that fell due since the last one
+    playTimer->setTimerType(Qt::PreciseTimer);
+    playTimer->setInterval(kPlaybackTickMs);
+
+    // Ctrl+Left and Ctrl+Right step one frame back and forth
+    QShortcut *stepBack = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_Left), this);
+    QShortcut *stepForward = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_Right), this);
+    connect(stepBack, &QShortcut::activated, this, [this]() { stepFrames(-1); });
+    connect(stepForward, &QShortcut::activated, this, [this]() { stepFrames(1); });
     
     // Initialize current frame table
     ui->currentFrameTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
@@ -47,6 +158,9 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    logLoader->cancel();
+    liveCapture->stop();
+    recorder->stop();
     delete ui;
 }
 
@@ -57,7 +171,7 @@ void MainWindow::on_btnLoadFile_clicked()
     }
     // Open file dialog with filters for .log and .csv files
     QString filePath = QFileDialog::getOpenFileName(this, "Open CAN Log File", "",
-                                                    "Log Files (*.log);;CSV Files (*.csv);;All Files (*)");
+                                                    "Log Files (*.log);;CSV Files (*.csv);;Recordings (*.canrec);;All Files (*)");
 
     if (!filePath.isEmpty())
     {
@@ -70,128 +184,478 @@ void MainWindow::on_btnLoadFile_clicked()
 
 void MainWindow::loadCANLogFile(const QString &filePath)
 {
-    if (filePath.endsWith(".log", Qt::CaseInsensitive))
+    if (!filePath.endsWith(".log", Qt::CaseInsensitive) && !filePath.endsWith(".csv", Qt::CaseInsensitive)
+        && !filePath.endsWith(".canrec", Qt::CaseInsensitive))
     {
-        // Handle .log file parsing
-        QFile file(filePath);
+        QMessageBox::warning(this, "Unsupported File",
+                             "The selected file format is not supported.");
+        return;
+    }
 
-        // Attempt to open the .log file
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-        {
-            QMessageBox::critical(this, "Error", "Unable to open the LOG file.");
-            return;
-        }
+    // Parsing runs on the loader's worker thread, frames arrive in appendFrames()
+    stopCapture();
+    logLoader->cancel();
+    resetFrameData();
+    loadTimer.start();
+    ui->btnCancelLoad->setEnabled(true);
+    ui->statusbar->showMessage(QString("Loading %1...").arg(filePath));
+    logLoader->start(filePath);
+}
 
-        // Clear existing data in the table
-        ui->tableCANData->setRowCount(0);
-        ui->currentFrameTable->clearContents();
-        currentRow = 0;
-        ui->progressBar->setValue(0);
-        ui->progressBar_2->setValue(0);
+void MainWindow::appendFrames(std::shared_ptr<CANFrameStore> chunk)
+{
+    if (chunk->empty())
+    {
+        return;
+    }
+    if (!frameStore.canAppend(*chunk))
+    {
+        // Pieces parsed apart can still name too many interfaces between them
+        logLoader->cancel();
+        stopCapture();
+        loadFailed(QString("The file uses more than %1 interface names, which cannot be told apart.")
+                       .arg(CANFrameStore::kMaxInterfaces));
+        return;
+    }
+    size_t firstNewRow = frameStore.size();
+
+    frameModel->beginAppend(static_cast<int>(chunk->size()));
+    if (frameStore.empty())
+    {
+        frameStore.swap(*chunk); // the first chunk (or a whole sidecar) is taken over, not copied
+    }
+    else
+    {
+        frameStore.append(*chunk);
+    }
+    frameModel->endAppend();
+    dbcDatabase.bindInterfaces(frameStore.interfaceNames());
+    timeIndex.update(frameStore);
+
+    // Give every newly seen ID its place in the grid straight away
+    std::vector<uint32_t> newKeys;
+    idIndex.update(frameStore, &newKeys);
+    for (uint32_t key : newKeys)
+    {
+        ui->activityMap->addKey(key);
+        ui->comboPlotID->addItem(formatCANID(CANIDIndex::idOf(key), CANIDIndex::flagsOf(key)), key);
+    }
+    filterNewFrames(firstNewRow, newKeys);
 
-        QTextStream in(&file);
-        int rowCount = 0;
+    busStatistics.update(frameStore, logLoader->effectiveThreadCount());
+    statisticsStale = true;
+    if (ui->Tabs->currentWidget() == ui->Tab3Statistics)
+    {
+        refreshStatistics();
+    }
+    plotStale = true;
+    if (ui->Tabs->currentWidget() == ui->Tab4Plot)
+    {
+        extendPlot();
+    }
+    busState.update(frameStore);
+    updateMemoryLabel();
+}
 
-        // Regular expression to parse log lines
-        QRegularExpression logRegex(R"(\((.*?)\)\s+(.*?)\s+(.*?)#(.*))");
-        // Explanation for regex:
-        // - \(.*?\): Captures the timestamp (anything inside parentheses)
-        // - \s+: Matches whitespace
-        // - .*?: Captures the CAN interface (e.g., "can0")
-        // - .*?#(.*): Captures CAN ID and data separated by #
+void MainWindow::updateMemoryLabel()
+{
+    constexpr double kMiB = 1024.0 * 1024.0;
+    QString frames = filterModel->isFiltered()
+        ? QString("%1 of %2 frames").arg(filterModel->rowCount()).arg(frameStore.size())
+        : QString("%1 frames").arg(frameStore.size());
+    size_t storeBytes = frameStore.memoryUsage();
+    size_t indexBytes = idIndex.memoryUsage();
+    size_t cacheBytes = frameModel->decodeCacheUsage();
+    memoryLabel->setText(QString("%1   %2 MiB")
+                             .arg(frames)
+                             .arg((storeBytes + indexBytes + cacheBytes) / kMiB, 0, 'f', 1));
+    memoryLabel->setToolTip(QString("Frames: %1 MiB\nID index: %2 MiB\nDecoded signal cache: %3 MiB")
+                                .arg(storeBytes / kMiB, 0, 'f', 1)
+                                .arg(indexBytes / kMiB, 0, 'f', 1)
+                                .arg(cacheBytes / kMiB, 0, 'f', 1));
+}
 
-        while (!in.atEnd())
-        {
-            QString line = in.readLine();
+void MainWindow::refreshStatistics()
+{
+    statisticsModel->refresh(busStatistics);
+    statisticsStale = false;
+
+    // Bus load needs the bitrate, which logs do not record
+    constexpr uint64_t kAssumedBitrate = 500000;
+    QStringList loads;
+    const std::vector<InterfaceStatistics> &interfaces = busStatistics.interfaces();
+    for (size_t i = 0; i < interfaces.size() && i < frameStore.interfaceNames().size(); ++i)
+    {
+        loads << QString("%1: %2 % (%3 frames)")
+                     .arg(QString::fromStdString(frameStore.interfaceNames()[i]))
+                     .arg(interfaces[i].load(kAssumedBitrate) * 100.0, 0, 'f', 1)
+                     .arg(interfaces[i].frames);
+    }
+    ui->lblBusLoad->setText(loads.isEmpty() ? QString("No frames loaded")
+                                            : QString("Bus load at %1 kbit/s   %2")
+                                                  .arg(kAssumedBitrate / 1000).arg(loads.join("   ")));
+}
 
-            // Match the line with the regex
-            QRegularExpressionMatch match = logRegex.match(line);
-            if (match.hasMatch())
-            {
-                QString timestamp = match.captured(1);
-                QString canInterface = match.captured(2);
-                QString canID = match.captured(3);
-                QString dataBytes = match.captured(4);
-
-                // Add a new row to the table
-                int currentRow = ui->tableCANData->rowCount();
-                ui->tableCANData->insertRow(currentRow);
-
-                // Populate the table columns
-                ui->tableCANData->setItem(currentRow, 0, new QTableWidgetItem(timestamp));
-                ui->tableCANData->setItem(currentRow, 1, new QTableWidgetItem(canID));
-                ui->tableCANData->setItem(currentRow, 2, new QTableWidgetItem(dataBytes));
-                ui->tableCANData->setItem(currentRow, 3, new QTableWidgetItem(canInterface));
-
-                rowCount++;
-            }
-        }
+void MainWindow::updateLoadProgress(qint64 bytesParsed, qint64 bytesTotal)
+{
+    double fraction = bytesTotal > 0 ? static_cast<double>(bytesParsed) / bytesTotal : 1.0;
+    ui->progressBar->setFraction(fraction);
+    ui->progressBar_2->setFraction(fraction);
+}
 
-        file.close(); // Close the file after reading
+void MainWindow::loadFinished(size_t malformedLines, bool fromSidecar)
+{
+    ui->btnCancelLoad->setEnabled(false);
+    frameStore.shrinkToFit();
+    updateMemoryLabel();
+    setPlaybackPosition(0);
 
-        QMessageBox::information(this, "File Loaded",
-                                 QString("Successfully loaded %1 rows from the LOG file!").arg(rowCount));
+    // Next time this log opens straight from its .canidx sidecar
+    if (!fromSidecar)
+    {
+        logLoader->saveSidecar(&frameStore);
     }
-    else if (filePath.endsWith(".csv", Qt::CaseInsensitive))
+
+    QString summary = QString("Successfully loaded %1 rows in %2 ms%3!")
+                          .arg(frameStore.size())
+                          .arg(loadTimer.elapsed())
+                          .arg(fromSidecar ? " from the index cache" : "");
+    if (malformedLines > 0)
     {
-        // Handle .csv file parsing
-        QFile file(filePath);
+        summary += QString("\n%1 lines could not be parsed.").arg(malformedLines);
+    }
+    ui->statusbar->clearMessage();
+    QMessageBox::information(this, "File Loaded", summary);
+}
+
+void MainWindow::sortFramesByTime()
+{
+    // Parallel pieces of the log overlapped in time, show them merged
+    if (isPlaying)
+    {
+        Play();
+    }
+    frameStore.sortByTimestamp();
+    frameModel->reload();
+    timeIndex.clear();
+    timeIndex.update(frameStore);
+    idIndex.clear();
+    idIndex.update(frameStore);
+    refilter();
+    clearSearch();
+    busStatistics.clear();
+    busStatistics.update(frameStore, logLoader->effectiveThreadCount());
+    refreshStatistics();
+    populatePlotIDs();
+    busState.clear();
+    busState.update(frameStore);
+    currentRow = 0;
+    shownRow = -1;
+    refreshBusState();
+    updateMemoryLabel();
+}
+
+void MainWindow::setParseThreadCount(int threads)
+{
+    logLoader->setThreadCount(threads);
+}
+
+void MainWindow::setIndexCacheEnabled(bool enabled)
+{
+    logLoader->setSidecarEnabled(enabled);
+}
+
+void MainWindow::setDecodeCacheBudget(size_t bytes)
+{
+    frameModel->setDecodeCacheBudget(bytes);
+}
 
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+void MainWindow::loadFailed(const QString &message)
+{
+    ui->btnCancelLoad->setEnabled(false);
+    ui->statusbar->clearMessage();
+    resetFrameData();
+    QMessageBox::critical(this, "Error", message);
+}
+
+void MainWindow::cancelLoad()
+{
+    if (!logLoader->isRunning())
+    {
+        return;
+    }
+
+    // Drop the partially loaded file rather than leave half a log on screen
+    logLoader->cancel();
+    resetFrameData();
+    ui->btnCancelLoad->setEnabled(false);
+    ui->lblSelectedFile->setText("No file selected");
+    ui->statusbar->showMessage("Loading cancelled", 3000);
+}
+
+namespace {
+// Opens the capture source named by source: SocketCAN interfaces
+// ("can0,vcan0"), a cannelloni UDP listener ("cannelloni://[address][:port][/name]")
+// or socketcand buses ("socketcand://host[:port]/can0,can1")
+std::unique_ptr<LiveReader> openLiveReader(const QString &source, QString &error)
+{
+    QUrl url(source.trimmed());
+    if (url.scheme() == "cannelloni")
+    {
+        auto reader = std::make_unique<CannelloniReader>();
+        QString name = url.path().remove(0, 1);
+        if (!reader->open(url.host().toStdString(), static_cast<uint16_t>(url.port(CannelloniReader::kDefaultPort)),
+                          name.isEmpty() ? "cannelloni" : name.toStdString()))
         {
-            QMessageBox::critical(this, "Error", "Unable to open the CSV file.");
-            return;
+            error = reader->errorString();
+            return nullptr;
         }
+        return reader;
+    }
 
-        // Clear the existing data in the table
-        ui->tableCANData->setRowCount(0);
-        ui->currentFrameTable->clearContents();
-        currentRow = 0;
-        ui->progressBar->setValue(0);
-        ui->progressBar_2->setValue(0);
+    std::vector<std::string> interfaces;
+    bool socketcand = url.scheme() == "socketcand";
+    for (const QString &name : (socketcand ? url.path().remove(0, 1) : source).split(',', Qt::SkipEmptyParts))
+    {
+        interfaces.push_back(name.trimmed().toStdString());
+    }
+    if (socketcand)
+    {
+        auto reader = std::make_unique<SocketcandReader>();
+        if (!reader->open(url.host().toStdString(), static_cast<uint16_t>(url.port(SocketcandReader::kDefaultPort)),
+                          interfaces))
+        {
+            error = reader->errorString();
+            return nullptr;
+        }
+        return reader;
+    }
 
-        QTextStream in(&file);
-        int rowCount = 0;
-        QStringList headers;
+    auto reader = std::make_unique<SocketCANReader>();
+    if (!reader->open(interfaces))
+    {
+        error = reader->errorString();
+        return nullptr;
+    }
+    return reader;
+}
+}
 
-        // Read the file line by line
-        while (!in.atEnd())
-        {
-            QString line = in.readLine();
+bool MainWindow::startCapture(const QString &source)
+{
+    QString message;
+    std::unique_ptr<LiveReader> reader = openLiveReader(source, message);
+    if (!reader)
+    {
+        QSignalBlocker blockButton(ui->btnLiveCapture);
+        ui->btnLiveCapture->setChecked(liveCapture->isRunning());
+        QMessageBox::critical(this, "Live Capture", message);
+        return false;
+    }
 
-            // Split the line by commas for CSV parsing
-            QStringList columns = line.split(',');
+    // A capture replaces whatever was loaded, like opening a log does
+    stopCapture();
+    logLoader->cancel();
+    resetFrameData();
+    ui->btnCancelLoad->setEnabled(false);
+    QStringList names;
+    for (const std::string &name : reader->interfaces())
+    {
+        names << QString::fromStdString(name);
+    }
+    ui->lblSelectedFile->setText(QString("Capturing %1").arg(names.join(", ")));
+    liveCapture->start(std::move(reader));
+    QSignalBlocker blockButton(ui->btnLiveCapture);
+    ui->btnLiveCapture->setChecked(true);
+    showCaptureStatus();
+    return true;
+}
 
-            // Use the first line as headers
-            if (rowCount == 0)
-            {
-                headers = columns;
-                ui->tableCANData->setColumnCount(headers.size());
-                ui->tableCANData->setHorizontalHeaderLabels(headers);
-            }
-            else
-            {
-                // Insert a new row for each subsequent line
-                ui->tableCANData->insertRow(ui->tableCANData->rowCount());
-                for (int col = 0; col < columns.size(); ++col)
-                {
-                    ui->tableCANData->setItem(rowCount - 1, col, new QTableWidgetItem(columns[col]));
-                }
-            }
+void MainWindow::stopCapture()
+{
+    if (!liveCapture->isRunning())
+    {
+        return;
+    }
+    liveCapture->stop();
+    QSignalBlocker blockButton(ui->btnLiveCapture);
+    ui->btnLiveCapture->setChecked(false);
+    ui->lblSelectedFile->setText(ui->lblSelectedFile->text().replace("Capturing", "Captured"));
+    showCaptureStatus();
+}
 
-            rowCount++;
-        }
+void MainWindow::toggleLiveCapture()
+{
+    if (liveCapture->isRunning())
+    {
+        stopCapture();
+        return;
+    }
 
-        file.close();
+    bool accepted = false;
+    QString text = QInputDialog::getText(this, "Live Capture",
+                                         "SocketCAN interfaces (comma separated), cannelloni://[address][:port]\n"
+                                         "or socketcand://host[:port]/can0,can1:",
+                                         QLineEdit::Normal, "can0", &accepted);
+    if (!accepted || text.trimmed().isEmpty())
+    {
+        QSignalBlocker blockButton(ui->btnLiveCapture);
+        ui->btnLiveCapture->setChecked(false);
+        return;
+    }
+    startCapture(text);
+}
 
-        QMessageBox::information(this, "File Loaded",
-                                 QString("Successfully loaded %1 rows from the CSV file!").arg(rowCount));
+void MainWindow::showCaptureStatus()
+{
+    // Anything but zero drops means frames are missing from the capture
+    LiveCaptureCounters counters = liveCapture->counters();
+    QString status = QString("%1 %2 frames   %3 dropped by the GUI ring   %4 dropped by the kernel")
+                         .arg(liveCapture->isRunning() ? "Capturing" : "Captured")
+                         .arg(counters.received)
+                         .arg(counters.ringOverflows)
+                         .arg(counters.kernelDrops);
+    if (counters.readErrors > 0)
+    {
+        status += QString("   %1 read errors").arg(counters.readErrors);
     }
-    else
+    if (counters.connectionsClosed > 0)
     {
-        QMessageBox::warning(this, "Unsupported File",
-                             "The selected file format is not supported.");
+        status += QString("   %1 connections closed").arg(counters.connectionsClosed);
+    }
+    if (counters.packetsLost > 0 || counters.packetsReordered > 0 || counters.packetsMalformed > 0)
+    {
+        status += QString("   packets: %1 lost, %2 reordered, %3 malformed")
+                      .arg(counters.packetsLost)
+                      .arg(counters.packetsReordered)
+                      .arg(counters.packetsMalformed);
+    }
+    if (recorder->isRecording())
+    {
+        FrameRecorder::Counters recorded = recorder->counters();
+        status += QString("   recorded %1 frames to %2").arg(recorded.frames).arg(recorder->currentFile());
+    }
+    ui->statusbar->showMessage(status);
+}
+
+void MainWindow::captureSourceClosed()
+{
+    // Every connection of a network source is gone, nothing more will arrive
+    stopCapture();
+    QMessageBox::warning(this, "Live Capture", "The capture source closed the connection, capture stopped.");
+}
+
+bool MainWindow::startRecording(const QString &path, const QString &filter)
+{
+    FrameRecorder::Settings settings;
+    settings.path = path;
+    settings.format = FrameRecorder::formatForPath(path);
+    settings.rotateBytes = recordRotateBytes;
+    settings.rotateSeconds = recordRotateSeconds;
+
+    QString message;
+    if (!filter.isEmpty() && !settings.filter.compile(filter.toStdString()))
+    {
+        message = QString::fromStdString(settings.filter.errorString());
     }
+    else if (!recorder->start(settings))
+    {
+        message = recorder->errorString();
+    }
+
+    QSignalBlocker blockButton(ui->btnRecord);
+    ui->btnRecord->setChecked(message.isEmpty());
+    if (!message.isEmpty())
+    {
+        QMessageBox::critical(this, "Recording", message);
+        return false;
+    }
+    ui->statusbar->showMessage(QString("Recording to %1").arg(recorder->currentFile()), 3000);
+    return true;
+}
+
+void MainWindow::setRecordRotation(qint64 bytes, qint64 seconds)
+{
+    recordRotateBytes = std::max<qint64>(bytes, 0);
+    recordRotateSeconds = std::max<qint64>(seconds, 0);
+}
+
+void MainWindow::stopRecording()
+{
+    recorder->stop();
+    QSignalBlocker blockButton(ui->btnRecord);
+    ui->btnRecord->setChecked(false);
+    FrameRecorder::Counters recorded = recorder->counters();
+    ui->statusbar->showMessage(QString("Recorded %1 frames (%2 MiB) into %3 file(s)")
+                                   .arg(recorded.frames)
+                                   .arg(recorded.bytes / (1024.0 * 1024.0), 0, 'f', 1)
+                                   .arg(recorded.files), 5000);
+}
+
+void MainWindow::toggleRecording()
+{
+    if (recorder->isRecording())
+    {
+        stopRecording();
+        return;
+    }
+
+    // Frames from a live capture are recorded as they arrive, from now on
+    QString path = QFileDialog::getSaveFileName(this, "Record To", "",
+                                                "Log Files (*.log);;Recordings (*.canrec)");
+    if (path.isEmpty())
+    {
+        QSignalBlocker blockButton(ui->btnRecord);
+        ui->btnRecord->setChecked(false);
+        return;
+    }
+    QString filter;
+    if (filterMode == FilterMode::Expression
+        && QMessageBox::question(this, "Recording",
+                                 QString("Record only the frames matching the table filter?\n%1").arg(filterText))
+               == QMessageBox::Yes)
+    {
+        filter = filterText;
+    }
+    startRecording(path, filter);
+}
+
+void MainWindow::recordingFailed(const QString &message)
+{
+    stopRecording();
+    QMessageBox::critical(this, "Recording", QString("Recording stopped: %1").arg(message));
+}
+
+void MainWindow::resetFrameData()
+{
+    // Clear existing data in the store, the table and the ID grid
+    if (isPlaying)
+    {
+        Play();
+    }
+    frameStore.clear();
+    frameStore.shrinkToFit();
+    dbcDatabase.bindInterfaces(frameStore.interfaceNames());
+    frameModel->reload();
+    timeIndex.clear();
+    idIndex.clear();
+    ui->currentFrameTable->clearContents();
+    currentRow = 0;
+    ui->progressBar->setFraction(0.0);
+    ui->progressBar_2->setFraction(0.0);
+
+    ui->activityMap->clear();
+
+    // An active filter stays in force for the frames of the next load
+    refilter();
+    clearSearch();
+    busStatistics.clear();
+    refreshStatistics();
+    populatePlotIDs();
+    busState.clear();
+    shownRow = -1;
+    refreshBusState();
+    updateMemoryLabel();
 }
 
 void MainWindow::on_btnApplyFilter_clicked()
@@ -208,41 +672,379 @@ void MainWindow::on_btnApplyFilter_clicked()
 
 void MainWindow::applyFilter(const QString &filterID)
 {
+    // A bare hex string keeps its old meaning, IDs containing it. Anything
+    // else is a filter expression (see filter_expression.h).
+    static const QRegularExpression plainID("^[0-9A-Fa-f]*$");
+    QString text = filterID.trimmed();
+
+    if (text.isEmpty())
+    {
+        filterMode = FilterMode::None;
+    }
+    else if (plainID.match(text).hasMatch())
+    {
+        filterMode = FilterMode::IDText;
+    }
+    else
+    {
+        FilterExpression expression;
+        if (!expression.compile(text.toStdString()))
+        {
+            QMessageBox::warning(this, "Invalid Filter", QString::fromStdString(expression.errorString()));
+            return;
+        }
+        filterMode = FilterMode::Expression;
+        filterExpression = std::move(expression);
+    }
+    filterText = text;
+    refilter();
 
-    // Filter table rows based on the provided filter ID
-    int rowCount = ui->tableCANData->rowCount();
+    QMessageBox::information(this, "Filter Applied",
+                             QString("Filter applied: %1\n%2 frames match.").arg(text).arg(filterModel->rowCount()));
+}
 
-    for (int row = 0; row < rowCount; ++row)
+bool MainWindow::filterIsByID() const
+{
+    return filterMode == FilterMode::IDText
+        || (filterMode == FilterMode::Expression && filterExpression.usesOnlyID());
+}
+
+std::vector<uint32_t> MainWindow::acceptedKeys(const std::vector<uint32_t> &keys) const
+{
+    if (filterMode == FilterMode::Expression)
     {
-        // Check if the CAN ID matches the filter ID
-        QTableWidgetItem *item = ui->tableCANData->item(row, 1);
-        if (item)
+        return filterExpression.matchingKeys(keys);
+    }
+    std::vector<uint32_t> accepted;
+    for (uint32_t key : keys)
+    {
+        if (formatCANID(CANIDIndex::idOf(key), CANIDIndex::flagsOf(key)).contains(filterText, Qt::CaseInsensitive))
         {
-            bool matches = item->text().contains(filterID, Qt::CaseInsensitive);
-            ui->tableCANData->setRowHidden(row, !matches); // Hide non-matching rows
+            accepted.push_back(key);
         }
     }
+    return accepted;
+}
 
-    for (int i = 0; i < ui->gridLayout_2->count(); i++) {
-        QLineEdit *lineEdit = qobject_cast<QLineEdit*>(ui->gridLayout_2->itemAt(i)->widget());
-        if (lineEdit) {
-            bool matches = lineEdit->text().contains(filterID, Qt::CaseInsensitive);
-            lineEdit->setHidden(!matches);
+void MainWindow::updateLabelVisibility(const std::vector<uint32_t> &keys)
+{
+    bool byID = filterIsByID();
+    for (uint32_t key : keys)
+    {
+        ui->activityMap->setKeyHidden(key, byID && !filterKeys.contains(key));
+    }
+}
+
+void MainWindow::refilter()
+{
+    // Runs the active filter over the whole store; filterNewFrames() keeps
+    // the result current from then on
+    filterKeys.clear();
+    if (filterMode == FilterMode::None)
+    {
+        filterModel->clearRows();
+    }
+    else if (filterIsByID())
+    {
+        // The match is decided once per distinct ID, then the table shows the
+        // union of those IDs' rows straight from the index
+        std::vector<uint32_t> matchingKeys = acceptedKeys(idIndex.keys());
+        filterKeys = QSet<uint32_t>(matchingKeys.begin(), matchingKeys.end());
+        filterModel->setRows(idIndex.rowsOf(matchingKeys));
+    }
+    else
+    {
+        filterModel->setRows(filterExpression.matchingRows(frameStore, 0, frameStore.size(),
+                                                           logLoader->effectiveThreadCount()));
+    }
+    updateLabelVisibility(idIndex.keys());
+    updateMemoryLabel();
+}
+
+void MainWindow::filterNewFrames(size_t firstRow, const std::vector<uint32_t> &newKeys)
+{
+    // Only the appended frames are looked at, so the cost of keeping the
+    // filter applied does not grow with the length of the session
+    if (filterMode == FilterMode::None)
+    {
+        return;
+    }
+
+    if (!filterIsByID())
+    {
+        filterModel->appendRows(filterExpression.matchingRows(frameStore, firstRow, frameStore.size(),
+                                                              logLoader->effectiveThreadCount()));
+        return;
+    }
+
+    for (uint32_t key : acceptedKeys(newKeys))
+    {
+        filterKeys.insert(key);
+    }
+    updateLabelVisibility(newKeys);
+
+    std::vector<uint32_t> rows;
+    if (!filterKeys.isEmpty())
+    {
+        const FrameColumn<uint32_t> &ids = frameStore.ids();
+        const FrameColumn<uint8_t> &flags = frameStore.flagColumn();
+        for (size_t row = firstRow; row < frameStore.size(); ++row)
+        {
+            if (filterKeys.contains(CANIDIndex::keyOf(ids[row], flags[row])))
+            {
+                rows.push_back(static_cast<uint32_t>(row));
+            }
         }
     }
+    filterModel->appendRows(rows);
+}
+
+void MainWindow::searchNext()
+{
+    jumpToSearchHit(true);
+}
+
+void MainWindow::searchPrevious()
+{
+    jumpToSearchHit(false);
+}
+
+bool MainWindow::runSearch()
+{
+    QString patternText = ui->lineEditSearch->text().trimmed();
+    bool span = ui->checkSearchSpan->isChecked();
+    if (patternText == searchedPattern && span == searchedSpan && searchedRows == frameStore.size())
+    {
+        return !searchedPattern.isEmpty();
+    }
 
-    QMessageBox::information(this, "Filter Applied",
-                             QString("Filter applied for ID: %1").arg(filterID));
+    BytePattern pattern;
+    std::string error;
+    if (!BytePattern::parse(patternText.toStdString(), pattern, error))
+    {
+        QMessageBox::warning(this, "Invalid Search", QString::fromStdString(error));
+        return false;
+    }
+
+    QElapsedTimer searchTimer;
+    searchTimer.start();
+    searchHits = searchPayloads(frameStore, idIndex, pattern, span, logLoader->effectiveThreadCount());
+    searchedPattern = patternText;
+    searchedSpan = span;
+    searchedRows = frameStore.size();
+    searchHitIndex = -1;
+    ui->statusbar->showMessage(QString("%1 frames match %2 (%3 ms)")
+                                   .arg(searchHits.size()).arg(patternText).arg(searchTimer.elapsed()), 3000);
+    return true;
+}
+
+void MainWindow::jumpToSearchHit(bool forward)
+{
+    if (!runSearch())
+    {
+        return;
+    }
+    if (searchHits.empty())
+    {
+        ui->lblSearchHits->setText("No matches");
+        return;
+    }
+
+    // Step from the last hit while playback has not moved on, otherwise
+    // from the frame playback is at
+    uint32_t position = static_cast<uint32_t>(currentRow);
+    bool atHit = searchHitIndex >= 0 && searchHits[searchHitIndex] == position;
+    int count = static_cast<int>(searchHits.size());
+    int index;
+    if (forward)
+    {
+        index = atHit ? searchHitIndex + 1
+                      : static_cast<int>(std::lower_bound(searchHits.begin(), searchHits.end(), position) - searchHits.begin());
+        if (index >= count)
+        {
+            index = 0;
+        }
+    }
+    else
+    {
+        index = atHit ? searchHitIndex - 1
+                      : static_cast<int>(std::lower_bound(searchHits.begin(), searchHits.end(), position) - searchHits.begin()) - 1;
+        if (index < 0)
+        {
+            index = count - 1;
+        }
+    }
+
+    searchHitIndex = index;
+    int row = static_cast<int>(searchHits[index]);
+    seekToRow(row);
+    setPlaybackPosition(row);
+    ui->lblSearchHits->setText(QString("%1 of %2").arg(index + 1).arg(count));
+}
+
+void MainWindow::clearSearch()
+{
+    searchHits.clear();
+    searchedPattern.clear();
+    searchedRows = 0;
+    searchHitIndex = -1;
+    ui->lblSearchHits->clear();
+}
+
+void MainWindow::populatePlotIDs()
+{
+    // Keep the plotted ID selected when the index is rebuilt
+    QVariant selected = ui->comboPlotID->currentData();
+    {
+        QSignalBlocker blocker(ui->comboPlotID);
+        ui->comboPlotID->clear();
+        for (uint32_t key : idIndex.keys())
+        {
+            ui->comboPlotID->addItem(formatCANID(CANIDIndex::idOf(key), CANIDIndex::flagsOf(key)), key);
+        }
+        int index = selected.isValid() ? ui->comboPlotID->findData(selected) : -1;
+        ui->comboPlotID->setCurrentIndex(index >= 0 ? index : 0);
+    }
+    populatePlotSignals();
+}
+
+void MainWindow::populatePlotSignals()
+{
+    // The DBC signals of the selected ID, then its raw payload bytes
+    QString selected = ui->comboPlotSignal->currentText();
+    {
+        QSignalBlocker blocker(ui->comboPlotSignal);
+        ui->comboPlotSignal->clear();
+        if (ui->comboPlotID->currentIndex() >= 0)
+        {
+            uint32_t key = ui->comboPlotID->currentData().toUInt();
+            if (const MessageDecoder *found = plotDecoder(key))
+            {
+                const MessageDecoder &decoder = *found;
+                for (size_t i = 0; i < decoder.signalCount(); ++i)
+                {
+                    const DBCSignal &signal = decoder.signal(i);
+                    QString name = QString::fromStdString(decoder.name() + "." + signal.name);
+                    if (!signal.unit.empty())
+                    {
+                        name += QString(" [%1]").arg(QString::fromStdString(signal.unit));
+                    }
+                    ui->comboPlotSignal->addItem(name, static_cast<int>(i));
+                }
+            }
+            for (int byte = 0; byte < static_cast<int>(CANFrameStore::kPayloadStride); ++byte)
+            {
+                ui->comboPlotSignal->addItem(QString("Byte %1").arg(byte), -byte - 1);
+            }
+            int index = ui->comboPlotSignal->findText(selected);
+            ui->comboPlotSignal->setCurrentIndex(index >= 0 ? index : 0);
+        }
+    }
+    rebuildPlot();
+}
+
+void MainWindow::rebuildPlot()
+{
+    plotPyramid.clear();
+    plottedRows = 0;
+    plotKey = ui->comboPlotID->currentData().toUInt();
+    plotSource = ui->comboPlotSignal->currentData().toInt();
+    QString title;
+    if (ui->comboPlotSignal->currentIndex() >= 0)
+    {
+        title = QString("%1  %2").arg(ui->comboPlotID->currentText(), ui->comboPlotSignal->currentText());
+    }
+    ui->plotView->setPyramid(&plotPyramid, title);
+    extendPlot();
+}
+
+const MessageDecoder *MainWindow::plotDecoder(uint32_t key) const
+{
+    // An ID seen on several buses is plotted with the DBC of its first frame
+    const std::vector<uint32_t> *rows = idIndex.rows(key);
+    if (!rows || rows->empty())
+    {
+        return nullptr;
+    }
+    return dbcDatabase.find(key, frameStore.interfaceIndex(rows->front()));
+}
+
+void MainWindow::extendPlot()
+{
+    // Only rows of the plotted ID that arrived since the last call are added
+    plotStale = false;
+    const std::vector<uint32_t> *rows = ui->comboPlotSignal->currentIndex() >= 0 ? idIndex.rows(plotKey) : nullptr;
+    if (!rows || plottedRows >= rows->size())
+    {
+        return;
+    }
+    const uint32_t *newRows = rows->data() + plottedRows;
+    size_t count = rows->size() - plottedRows;
+    std::vector<double> values(count);
+    std::vector<uint8_t> present(count);
+    if (plotSource >= 0)
+    {
+        const MessageDecoder *decoder = plotDecoder(plotKey);
+        if (!decoder || static_cast<size_t>(plotSource) >= decoder->signalCount())
+        {
+            return;
+        }
+        // The first extension after a load can be millions of rows, decoded
+        // in row ranges on every core; live updates stay on this thread
+        SignalColumnRequest request;
+        request.rows = newRows;
+        request.count = count;
+        request.decoder = decoder;
+        request.signalIndex = static_cast<size_t>(plotSource);
+        std::vector<SignalColumn<double>> columns = decodeSignalColumns<double>(frameStore, {request});
+        values = std::move(columns[0].values);
+        present = std::move(columns[0].present);
+
+        // Frames of the ID on a bus with a different DBC are not this signal
+        for (size_t i = 0; i < count; ++i)
+        {
+            present[i] &= dbcDatabase.find(plotKey, frameStore.interfaceIndex(newRows[i])) == decoder;
+        }
+    }
+    else
+    {
+        size_t byte = static_cast<size_t>(-plotSource - 1);
+        for (size_t i = 0; i < count; ++i)
+        {
+            present[i] = frameStore.dlc(newRows[i]) > byte && !(frameStore.flags(newRows[i]) & FrameRemote);
+            values[i] = present[i] ? frameStore.payload(newRows[i])[byte] : 0.0;
+        }
+    }
+
+    std::vector<uint64_t> times;
+    times.reserve(count);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (present[i])
+        {
+            times.push_back(frameStore.timestamp(newRows[i]));
+            values[kept++] = values[i];
+        }
+    }
+    plotPyramid.append(times.data(), values.data(), kept);
+    plottedRows = rows->size();
+    ui->plotView->refresh();
 }
 
 void MainWindow::Play()
 {
     if (!isPlaying) {
-        // Start playing
-        if (currentRow >= ui->tableCANData->rowCount()) {
+        // Start playing, from the other end if this one was reached
+        if (playback.isReverse() && currentRow <= 0) {
+            currentRow = static_cast<int>(frameStore.size());
+        } else if (!playback.isReverse() && currentRow >= static_cast<int>(frameStore.size())) {
             currentRow = 0;
-            ui->progressBar->setValue(0);
-            ui->progressBar_2->setValue(0);
+            ui->progressBar->setFraction(0.0);
+            ui->progressBar_2->setFraction(0.0);
+        }
+        if (!frameStore.empty()) {
+            playback.start(frameStore.timestamp(std::min(static_cast<size_t>(currentRow), frameStore.size() - 1)));
         }
         playTimer->start();
         ui->btnPlay->setText("⏸");
@@ -252,6 +1054,7 @@ void MainWindow::Play()
     } else {
         // Pause playing
         playTimer->stop();
+        playback.stop();
         ui->btnPlay->setText("▶");
         ui->btnPlay_2->setText("▶");
         ui->btnPlay->setStyleSheet("background-color: green;"); 
@@ -282,67 +1085,212 @@ void MainWindow:: on_btnPlay_2_clicked()
     clickTimer.restart();
 }
 
-void MainWindow::updateLabel(const QString &canID, const QString &dataBytes)
+void MainWindow::updateTableRow()
 {
-    // Check if the label for the CAN ID already exists
-    if (!canIDLabelMap.contains(canID)) {
-        // Create a new label for the CAN ID
-        QLineEdit *lineEdit = new QLineEdit(this);
-        lineEdit->setFixedSize(50, 50);
-        lineEdit->setStyleSheet("background-color: red; border-radius: 25px;");
-        lineEdit->setAlignment(Qt::AlignCenter);
-        lineEdit->setText(canID);
-        canIDLabelMap.insert(canID, lineEdit);
+    size_t totalRows = frameStore.size();
+    size_t next = static_cast<size_t>(currentRow);
+    bool reverse = playback.isReverse();
+    if (reverse) {
+        size_t start = playback.dueRowsReverse(frameStore, timeIndex, next);
+        if (start < next) {
+            playFrames(start, next, true);
+            currentRow = static_cast<int>(start);
+        }
+    } else if (next < totalRows) {
+        size_t end = playback.dueRows(frameStore, timeIndex, next);
+        if (end > next) {
+            playFrames(next, end, false);
+            currentRow = static_cast<int>(end);
+        }
+    }
+    bool finished = reverse ? currentRow <= 0 : static_cast<size_t>(currentRow) >= totalRows;
+    if (finished) {
+        playTimer->stop();
+        playback.stop();
+        ui->btnPlay->setText("▶");
+        ui->btnPlay_2->setText("▶");
+        isPlaying = false;
+        currentRow = 0;
+        ui->progressBar->setFraction(reverse ? 0.0 : 1.0);
+        ui->progressBar_2->setFraction(reverse ? 0.0 : 1.0);
+    }
+}
 
-        int index = canIDLabelMap.size() - 1;
-        int row = index / 6;
-        int col = index % 6;
-        ui->gridLayout_2->addWidget(lineEdit, row, col);
+void MainWindow::playFrames(size_t first, size_t end, bool backwards)
+{
+    // The view lands on the frame of the batch played last, the newest or
+    // when going backwards the oldest; every frame in it lights its ID on
+    // the activity map
+    size_t landing = backwards ? first : end - 1;
+    setPlaybackPosition(static_cast<int>(landing));
+    selectFrameRow(static_cast<int>(landing));
+    showFrame(static_cast<int>(landing));
+    for (size_t row = first; row < end; ++row)
+    {
+        if (row != landing)
+        {
+            ui->activityMap->markSeen(CANIDIndex::keyOf(frameStore.id(row), frameStore.flags(row)));
+        }
     }
+}
 
-    // Get the label for the CAN ID
-    QLineEdit *lineEdit = canIDLabelMap.value(canID);
+void MainWindow::showFrame(int row)
+{
+    QString canID = formatCANID(frameStore.id(row), frameStore.flags(row));
+    QString dataBytes = formatPayload(frameStore.payload(row), frameStore.dlc(row), frameStore.flags(row));
+    ui->currentFrameTable->setItem(0, 0, new QTableWidgetItem(formatTimestamp(frameStore.timestamp(row))));
+    ui->currentFrameTable->setItem(0, 1, new QTableWidgetItem(canID));
+    QTableWidgetItem *dataItem = new QTableWidgetItem(dataBytes);
+    dataItem->setToolTip(decodedSignalsText(row));
+    ui->currentFrameTable->setItem(0, 2, dataItem);
+    ui->currentFrameTable->setItem(0, 3, new QTableWidgetItem(QString::fromStdString(frameStore.interfaceName(row))));
+
+    // Light the ID up on the activity map
+    ui->activityMap->markSeen(CANIDIndex::keyOf(frameStore.id(row), frameStore.flags(row)));
+
+    shownRow = row;
+    busStateStale = true;
+    if (ui->Tabs->currentWidget() == ui->Tab5State)
+    {
+        refreshBusState();
+    }
+}
 
-    // Flash the label green
-    lineEdit->setStyleSheet("background-color: green; border-radius: 25px;");
-    QTimer::singleShot(500, [lineEdit]() {
-        lineEdit->setStyleSheet("background-color: red; border-radius: 25px;");
-        });
+void MainWindow::refreshBusState()
+{
+    busStateStale = false;
+    if (shownRow < 0 || static_cast<size_t>(shownRow) >= busState.indexedRows())
+    {
+        busStateModel->clear();
+        ui->lblBusState->setText(frameStore.empty() ? QString("No frames loaded") : QString("No frame shown"));
+        return;
+    }
+
+    // Nearest checkpoint plus a replay of at most one interval
+    busState.stateAt(frameStore, static_cast<size_t>(shownRow), busStateRows);
+    busStateModel->setState(busState.keys(), busStateRows, static_cast<size_t>(shownRow));
+    ui->lblBusState->setText(QString("Bus state at %1 (frame %2): %3 of %4 IDs seen   checkpoints every %5 frames")
+                                 .arg(formatTimestamp(frameStore.timestamp(shownRow)))
+                                 .arg(shownRow + 1)
+                                 .arg(busStateModel->rowCount())
+                                 .arg(busState.keys().size())
+                                 .arg(busState.interval()));
 }
 
-void MainWindow::updateTableRow()
+QString MainWindow::decodedSignalsText(int row) const
 {
-    int totalRows = ui->tableCANData->rowCount();
-    if (currentRow < totalRows) {
-        int progressPercent = (currentRow * 100) / totalRows;
-        ui->progressBar->setValue(progressPercent);
-        ui->progressBar_2->setValue(progressPercent);
-        ui->tableCANData->selectRow(currentRow);
-        ui->tableCANData->scrollTo(ui->tableCANData->model()->index(currentRow, 0));
-        for (int col = 0; col < ui->tableCANData->columnCount(); col++) {
-            QTableWidgetItem* sourceItem = ui->tableCANData->item(currentRow, col);
-            if (sourceItem) {
-                QTableWidgetItem* newItem = new QTableWidgetItem(sourceItem->text());
-                ui->currentFrameTable->setItem(0, col, newItem);
-            }
-        }
+    // DBC IDs carry the extended flag in bit 31, like CANIDIndex keys
+    const MessageDecoder *found = dbcDatabase.find(CANIDIndex::keyOf(frameStore.id(row), frameStore.flags(row)),
+                                                   frameStore.interfaceIndex(row));
+    if (!found || (frameStore.flags(row) & FrameRemote))
+    {
+        return QString();
+    }
+
+    const MessageDecoder &decoder = *found;
+    std::vector<double> values(decoder.signalCount());
+    std::unique_ptr<bool[]> present(new bool[decoder.signalCount()]);
+    decoder.decode(frameStore.payload(row), frameStore.dlc(row), values.data(), present.get());
 
-        // Update the graph with the new data
-        QTableWidgetItem* canIDItem = ui->tableCANData->item(currentRow, 1);
-        QTableWidgetItem* dataBytesItem = ui->tableCANData->item(currentRow, 2);
-        if (canIDItem && dataBytesItem) {
-            updateLabel(canIDItem->text(), dataBytesItem->text());
+    QStringList lines(QString::fromStdString(decoder.name()));
+    for (size_t i = 0; i < decoder.signalCount(); ++i)
+    {
+        if (present[i])
+        {
+            const DBCSignal &signal = decoder.signal(i);
+            lines << QString("%1 = %2 %3").arg(QString::fromStdString(signal.name))
+                                          .arg(values[i], 0, 'g', 10)
+                                          .arg(QString::fromStdString(signal.unit));
         }
+    }
+    return lines.join('\n');
+}
 
-        currentRow++;
-    } else {
-        playTimer->stop();
-        ui->btnPlay->setText("▶");
-        ui->btnPlay_2->setText("▶");
-        isPlaying = false;
-        currentRow = 0;
-        ui->progressBar->setValue(100);
-        ui->progressBar_2->setValue(100);
+void MainWindow::setPlaybackPosition(int row)
+{
+    // The bars track time through the log rather than row count, so a busy
+    // stretch of bus traffic does not crowd the scrubber
+    double fraction = 0.0;
+    if (!timeIndex.empty() && row < static_cast<int>(frameStore.size())) {
+        uint64_t first = timeIndex.firstTimestamp();
+        uint64_t span = timeIndex.lastTimestamp() - first;
+        uint64_t timestamp = frameStore.timestamp(row);
+        fraction = span > 0 && timestamp > first ? static_cast<double>(timestamp - first) / span : 0.0;
+    }
+    ui->progressBar->setFraction(fraction);
+    ui->progressBar_2->setFraction(fraction);
+}
+
+void MainWindow::selectFrameRow(int row, QAbstractItemView::ScrollHint hint)
+{
+    // Frames hidden by the filter play without moving the selection
+    QModelIndex index = filterModel->mapFromSource(frameModel->index(row, 0));
+    if (index.isValid())
+    {
+        ui->tableCANData->selectRow(index.row());
+        ui->tableCANData->scrollTo(index, hint);
+    }
+}
+
+void MainWindow::seekToFraction(double fraction)
+{
+    // While loading the bars show parse progress and cannot be dragged
+    if (logLoader->isRunning() || timeIndex.empty()) {
+        return;
+    }
+
+    uint64_t first = timeIndex.firstTimestamp();
+    uint64_t span = timeIndex.lastTimestamp() - first;
+    uint64_t target = first + static_cast<uint64_t>(fraction * static_cast<double>(span));
+    size_t row = timeIndex.findRow(frameStore, target);
+    seekToRow(static_cast<int>(std::min(row, frameStore.size() - 1)));
+}
+
+void MainWindow::seekToRow(int row)
+{
+    if (row < 0 || row >= static_cast<int>(frameStore.size())) {
+        return;
+    }
+
+    // Playback carries on from here; the bars keep the dragged position
+    currentRow = row;
+    playback.seek(frameStore.timestamp(row));
+    selectFrameRow(row, QAbstractItemView::PositionAtCenter);
+    showFrame(row);
+}
+
+void MainWindow::stepFrames(int delta)
+{
+    if (frameStore.empty() || logLoader->isRunning()) {
+        return;
+    }
+
+    // Stepping pauses playback and moves from the shown frame
+    if (isPlaying) {
+        Play();
+    }
+    int row = shownRow < 0 ? 0 : shownRow + delta;
+    seekToRow(std::clamp(row, 0, static_cast<int>(frameStore.size()) - 1));
+    setPlaybackPosition(currentRow);
+}
+
+void MainWindow::setReversePlayback(bool reverse)
+{
+    // Both tabs' buttons show the direction
+    {
+        QSignalBlocker blockReverse(ui->btnReverse);
+        QSignalBlocker blockReverse2(ui->btnReverse_2);
+        ui->btnReverse->setChecked(reverse);
+        ui->btnReverse_2->setChecked(reverse);
+    }
+    if (reverse == playback.isReverse()) {
+        return;
+    }
+
+    // Carry on from the shown frame in the new direction
+    playback.setReverse(reverse);
+    if (shownRow >= 0) {
+        currentRow = reverse ? shownRow : shownRow + 1;
     }
 }
 
@@ -370,42 +1318,18 @@ void MainWindow:: on_btnFF_2_clicked()
 
 void MainWindow::FastForward()
 {
-        // Cycle through playback speeds: 1x, 2x, 4x, 8x, 16x, 32x
-    switch (playbackSpeed) {
-        case 1:
-            playbackSpeed = 2;
-            ui->btnFF->setText("2x");
-            ui->btnFF_2->setText("2x");
-            break;
-        case 2:
-            playbackSpeed = 4;
-            ui->btnFF->setText("4x");
-            ui->btnFF_2->setText("4x");
-            break;
-        case 4:
-            playbackSpeed = 8;
-            ui->btnFF->setText("8x");
-            ui->btnFF_2->setText("8x");
-            break;
-        case 8:
-            playbackSpeed = 16;
-            ui->btnFF->setText("16x");
-            ui->btnFF_2->setText("16x");
-            break;
-        case 16:
-            playbackSpeed = 32;
-            ui->btnFF->setText("32x");
-            ui->btnFF_2->setText("32x");
-            break;
-        default: 
-            playbackSpeed = 1;
-            ui->btnFF->setText("1x");
-            ui->btnFF_2->setText("1x");
-            break;
-    }
-
-    // Adjust the timer interval based on the playback speed
-    playTimer->setInterval(100 / playbackSpeed);
+    // Cycle through playback speeds: 1x up to 1000x, as fast as possible, then the slow speeds
+    static constexpr double kSpeeds[] = {1.0, 2.0, 4.0, 10.0, 100.0, 1000.0,
+                                         PlaybackScheduler::kAsFastAsPossible, 0.1, 0.25, 0.5};
+    constexpr size_t kSpeedCount = sizeof(kSpeeds) / sizeof(kSpeeds[0]);
+    speedIndex = (speedIndex + 1) % kSpeedCount;
+    double speed = kSpeeds[speedIndex];
+    playback.setSpeed(speed);
+
+    QString label = speed == PlaybackScheduler::kAsFastAsPossible ? QString("Max")
+                                                                  : QString("%1x").arg(speed);
+    ui->btnFF->setText(label);
+    ui->btnFF_2->setText(label);
 
     clickTimer.restart();
 }
@@ -415,64 +1339,103 @@ void MainWindow::on_btnLoadDBC_clicked()
     if (clickTimer.elapsed() < 300) {
         return;
     }
-    // Open file dialog with filters for .dbc files
-    QString filePathDBC = QFileDialog::getOpenFileName(this, "Open DBC File", "",
-                                                    "DBC Files (*.dbc);;All Files (*)");
-    if (filePathDBC.isEmpty()) {
+    // Open file dialog with filters for .dbc files; several files describe several buses
+    QStringList filePaths = QFileDialog::getOpenFileNames(this, "Open DBC Files", "",
+                                                          "DBC Files (*.dbc);;All Files (*)");
+    if (filePaths.isEmpty()) {
         return;
     }
-    ui->lblDBCFilePath->setText(filePathDBC); // Display selected file in the label
-    loadDBC(filePathDBC);
+
+    // A single DBC covers every interface, otherwise ask which bus each one describes
+    std::vector<DBCSource> sources;
+    const QString everyInterface = "All interfaces";
+    QStringList interfaceChoices(everyInterface);
+    for (const std::string &name : frameStore.interfaceNames()) {
+        interfaceChoices << QString::fromStdString(name);
+    }
+    for (const QString &filePath : filePaths) {
+        DBCSource source;
+        source.filePath = filePath;
+        if (filePaths.size() > 1) {
+            bool accepted = false;
+            QString choice = QInputDialog::getItem(this, "DBC Interface",
+                                                   QString("Interface described by %1:").arg(QFileInfo(filePath).fileName()),
+                                                   interfaceChoices, 0, true, &accepted);
+            if (!accepted) {
+                return;
+            }
+            if (choice != everyInterface) {
+                source.interfaceName = choice.trimmed().toStdString();
+            }
+        }
+        sources.push_back(std::move(source));
+    }
+
+    ui->lblDBCFilePath->setText(filePaths.join("; ")); // Display selected files in the label
+    loadDBC(sources);
 
     clickTimer.restart();
 }
 
-void MainWindow::loadDBC(const QString &filePathDBC)
+void MainWindow::loadDBC(const std::vector<DBCSource> &sources)
     {
-        QFile file(filePathDBC);
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QMessageBox::critical(this, "Error", "Unable to open the DBC file.");
-            return;
-        }
-    
-        QTextStream in(&file);
-        QString dbcContent = in.readAll();
-        file.close();
-    
-        DBCHandler dbcHandler;  
-        bool success = can::parse_dbc(dbcContent.toStdString(), std::ref(dbcHandler));
-    
+        // The table and plot hold decoders of the old database until it is replaced
+        frameModel->setDatabase(nullptr);
+
+        // Files are mapped and parsed in parallel, every message compiled
+        // once into shift/mask plans for its signals
+        bool success = dbcDatabase.load(sources, logLoader->effectiveThreadCount());
+        dbcDatabase.bindInterfaces(frameStore.interfaceNames());
+
+        // The table decodes the rows it draws, so the log is never decoded as a whole
+        frameModel->setDatabase(&dbcDatabase);
+        ui->tableCANData->setColumnHidden(CANFrameModel::ColumnMessage, !frameModel->hasDecoders());
+        ui->tableCANData->setColumnHidden(CANFrameModel::ColumnSignals, !frameModel->hasDecoders());
+        populatePlotSignals();
+        populateMessageTable(dbcDatabase);
+
         if (!success) {
-            QMessageBox::critical(this, "Error", "Failed to parse the DBC file.");
-            return;
-        }
-    
-        // Replace valTable with messages
-        if (!dbcHandler.messages.empty()) {
-            populateMessageTable(dbcHandler.messages);
-        } else {
-            QMessageBox::information(this, "No Messages", "The DBC file contains no messages.");
+            QMessageBox::critical(this, "Error", dbcDatabase.errorString());
+        } else if (dbcDatabase.empty()) {
+            QMessageBox::information(this, "No Messages", "The DBC files contain no messages.");
         }
     }
     
 
-void MainWindow::populateMessageTable(const std::map<uint32_t, std::string> &messages)
+void MainWindow::populateMessageTable(const DBCDatabase &database)
     {
         // Clear the table
         ui->valTableWidget->setRowCount(0);
     
         // Set the table headers for Message ID and Name
         ui->valTableWidget->setHorizontalHeaderLabels({"Message ID", "Message Name"});
+
+        // Sorted by ID, bus-specific messages after those for every interface
+        std::vector<size_t> order(database.messageCount());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&database](size_t a, size_t b) {
+            return std::make_pair(database.messageKey(a), database.messageInterface(a))
+                 < std::make_pair(database.messageKey(b), database.messageInterface(b));
+        });
     
         // Populate the table with message ID and name
         int row = 0;
-        for (const auto &message : messages)
+        for (size_t message : order)
         {
             ui->valTableWidget->insertRow(row);
+
+            QString name = QString::fromStdString(database.message(message).name());
+            if (!database.messageInterface(message).empty())
+            {
+                name = QString("%1: %2").arg(QString::fromStdString(database.messageInterface(message)), name);
+            }
     
             // Add message ID and name to the table
-            ui->valTableWidget->setItem(row, 0, new QTableWidgetItem(QString("0x%1").arg(message.first, 0, 16).toUpper()));
-            ui->valTableWidget->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(message.second)));
+            ui->valTableWidget->setItem(row, 0, new QTableWidgetItem(QString("0x%1").arg(database.messageKey(message), 0, 16).toUpper()));
+            ui->valTableWidget->setItem(row, 1, new QTableWidgetItem(name));
     
             row++;
         }
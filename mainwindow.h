@@ -11,10 +11,29 @@
 #include <QMap>
 #include <QGridLayout> 
 #include <QPropertyAnimation>
+#include <QAbstractItemView>
+#include <QSet>
+#include <memory>
 #include <string>
 #include <vector>
 #include <utility>
-#include "libs/can-utils/dbc/dbc_parser.h"
+#include "frame_store.h"
+#include "time_index.h"
+#include "can_id_index.h"
+#include "filter_expression.h"
+#include "bus_statistics.h"
+#include "dbc_database.h"
+#include "signal_pyramid.h"
+#include "playback_scheduler.h"
+#include "bus_state.h"
+
+class CANFrameModel;
+class CANFrameFilterModel;
+class BusStatisticsModel;
+class BusStateModel;
+class LogLoader;
+class LiveCapture;
+class FrameRecorder;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -27,7 +46,13 @@ class MainWindow : public QMainWindow
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
-    void populateMessageTable(const std::map<uint32_t, std::string> &messages);
+    void populateMessageTable(const DBCDatabase &database);
+    void setParseThreadCount(int threads); // 0 uses every core
+    void setIndexCacheEnabled(bool enabled); // .canidx sidecars next to loaded logs
+    void setDecodeCacheBudget(size_t bytes); // Memory for decoded signals of table rows
+    bool startCapture(const QString &source); // vcan0,vcan1 or cannelloni:// / socketcand:// URL
+    bool startRecording(const QString &path, const QString &filter = QString()); // .log or .canrec
+    void setRecordRotation(qint64 bytes, qint64 seconds); // 0 never rotates
 
 private slots:
     void on_btnLoadFile_clicked();
@@ -36,29 +61,116 @@ private slots:
     void on_btnPlay_2_clicked();
     void on_btnFF_clicked();
     void on_btnFF_2_clicked();
+    void setReversePlayback(bool reverse);
     void on_btnLoadDBC_clicked();
     void updateTableRow();
     void FastForward();
-    void updateLabel(const QString &canID, const QString &dataBytes);
+    void appendFrames(std::shared_ptr<CANFrameStore> chunk);
+    void updateLoadProgress(qint64 bytesParsed, qint64 bytesTotal);
+    void loadFinished(size_t malformedLines, bool fromSidecar);
+    void loadFailed(const QString &message);
+    void sortFramesByTime();
+    void cancelLoad();
+    void toggleLiveCapture();
+    void showCaptureStatus();
+    void captureSourceClosed();
+    void toggleRecording();
+    void recordingFailed(const QString &message);
+    void seekToFraction(double fraction);
+    void searchNext();
+    void searchPrevious();
+    void refreshStatistics();
+    void populatePlotSignals();
+    void rebuildPlot();
+    void refreshBusState();
 
 private:
     Ui::MainWindow *ui;
     void loadCANLogFile(const QString &filePath);
-    void loadDBC(const QString &filePathDBC);
+    void stopCapture();
+    void stopRecording();
+    void resetFrameData();
+    void loadDBC(const std::vector<DBCSource> &sources);
     void applyFilter(const QString &filterID);
+    void refilter();
+    void filterNewFrames(size_t firstRow, const std::vector<uint32_t> &newKeys);
+    bool filterIsByID() const;
+    std::vector<uint32_t> acceptedKeys(const std::vector<uint32_t> &keys) const;
+    void updateLabelVisibility(const std::vector<uint32_t> &keys);
+    bool runSearch();
+    void jumpToSearchHit(bool forward);
+    void clearSearch();
+    void populatePlotIDs();
+    void extendPlot();
+    const MessageDecoder *plotDecoder(uint32_t key) const;
     void Play();
+    void seekToRow(int row);
+    void stepFrames(int delta);
+    void showFrame(int row);
+    void playFrames(size_t first, size_t end, bool backwards);
+    QString decodedSignalsText(int row) const;
+    void setPlaybackPosition(int row);
+    void updateMemoryLabel();
+    void selectFrameRow(int row, QAbstractItemView::ScrollHint hint = QAbstractItemView::EnsureVisible);
+
+    CANFrameStore frameStore; // Every loaded frame, read by the table, playback and filter
+    CANFrameModel *frameModel; // Virtual table model over frameStore
+    CANFrameFilterModel *filterModel; // Rows of frameModel shown in the table
+    TimeIndex timeIndex; // Timestamp to row lookup for seeking
+    CANIDIndex idIndex; // Rows of every CAN ID, for filtering and the ID grid
+
+    // The active table filter, kept applied as frames are appended
+    enum class FilterMode { None, IDText, Expression };
+    FilterMode filterMode = FilterMode::None;
+    QString filterText;
+    FilterExpression filterExpression;
+    QSet<uint32_t> filterKeys; // Keys accepted by a filter that only tests IDs
+
+    BusStatistics busStatistics; // Per-ID and per-interface traffic figures, updated per chunk
+    BusStatisticsModel *statisticsModel;
+    bool statisticsStale = false; // busStatistics moved on since the tab was last refreshed
+
+    // The plotted signal or payload byte of one ID, extended as frames arrive
+    SignalPyramid plotPyramid;
+    uint32_t plotKey = 0;
+    int plotSource = 0; // DBC signal index, or -1 - byte for a raw payload byte
+    size_t plottedRows = 0; // Rows of plotKey already in plotPyramid
+    bool plotStale = false;
+
+    // Last frame of every ID at the shown row, rebuilt from checkpoints
+    BusStateIndex busState;
+    BusStateModel *busStateModel;
+    std::vector<uint32_t> busStateRows; // Scratch for BusStateIndex::stateAt
+    bool busStateStale = false;
+
+    // Rows matching the last payload search, rerun once pattern or store change
+    std::vector<uint32_t> searchHits;
+    QString searchedPattern;
+    bool searchedSpan = false;
+    size_t searchedRows = 0;
+    int searchHitIndex = -1;
+    LogLoader *logLoader; // Background parser feeding frameStore
+    LiveCapture *liveCapture; // Reader thread feeding frameStore from live interfaces
+    FrameRecorder *recorder; // Writes captured frames to disk on its own thread
+    qint64 recordRotateBytes = 0;
+    qint64 recordRotateSeconds = 0;
+    QElapsedTimer loadTimer;
+    QLabel *memoryLabel; // Frame count and memory use, permanent in the status bar
 
+    static constexpr int kPlaybackTickMs = 16; // About one batch per screen refresh
     QTimer *playTimer;
-    int currentRow;
+    PlaybackScheduler playback; // Log time due at each tick, from a monotonic clock
+    size_t speedIndex = 0;
+    int currentRow; // Next row to play forwards, or the end of the next batch backwards
+    int shownRow = -1; // Row in the current frame table
     bool isPlaying;
     QElapsedTimer clickTimer; 
-    int playbackSpeed;
     QWidget *sideBarWidget; 
     bool isSidebarVisible;
 
-    QMap<QString, QLineEdit*> canIDLabelMap; // Map to store editable labels for each CAN ID
     QGridLayout *gridLayout;
     QTableWidget *valTableWidget; // Pointer to the VAL_TABLE widget    
+    DBCDatabase dbcDatabase; // Compiled messages of every loaded DBC, by bus and CANIDIndex key
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,59 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+// Read-only memory mapping of a whole file. Uses QFile::map so it works the
+// same on Linux, macOS and Windows; the mapping lives as long as the object.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const QString &filePath)
+    {
+        close();
+        file.setFileName(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        fileSize = file.size();
+        if (fileSize > 0) {
+            mapped = file.map(0, fileSize);
+            if (!mapped) {
+                file.close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if (mapped) {
+            file.unmap(mapped);
+            mapped = nullptr;
+        }
+        if (file.isOpen()) {
+            file.close();
+        }
+        fileSize = 0;
+    }
+
+    const char *begin() const { return reinterpret_cast<const char *>(mapped); }
+    const char *end() const { return begin() + fileSize; }
+    qint64 size() const { return fileSize; }
+    QString errorString() const { return file.errorString(); }
+
+private:
+    QFile file;
+    uchar *mapped = nullptr;
+    qint64 fileSize = 0;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,554 @@
+#include "network_reader.h"
+#include "can_log_parser.h"
+#include "hex_decode.h"
+
+#ifdef __linux__
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#endif
+
+CannelloniReader::~CannelloniReader()
+{
+#ifdef __linux__
+    if (socketFd >= 0) {
+        ::close(socketFd);
+    }
+#endif
+}
+
+SocketcandReader::~SocketcandReader()
+{
+    close();
+}
+
+#ifdef __linux__
+
+namespace {
+// Longest a stop request can go unnoticed while the network is silent
+constexpr int kPollTimeoutMs = 100;
+
+// Kernel receive buffer asked for per socket, to ride out short stalls of
+// the reader thread
+constexpr int kReceiveBufferBytes = 8 * 1024 * 1024;
+
+// How long the socketcand handshake may take per step
+constexpr int kHandshakeTimeoutSeconds = 3;
+
+// cannelloni packet layout (version 2): version u8, op code u8, sequence u8,
+// frame count u16 big-endian, then per frame the Linux can_id u32 big-endian,
+// the length u8 (bit 7 marks CAN FD, followed by the FD flags u8) and the
+// payload, which remote frames leave out
+constexpr uint8_t kCannelloniVersion = 2;
+constexpr uint8_t kCannelloniData = 0;
+constexpr size_t kCannelloniHeaderBytes = 5;
+constexpr uint8_t kCannelloniFDFrame = 0x80;
+
+// Linux can_id bits, as carried by both protocols
+constexpr uint32_t kEffFlag = 0x80000000U;  // CAN_EFF_FLAG
+constexpr uint32_t kRtrFlag = 0x40000000U;  // CAN_RTR_FLAG
+constexpr uint32_t kErrFlag = 0x20000000U;  // CAN_ERR_FLAG
+constexpr uint32_t kEffMask = 0x1FFFFFFFU;  // CAN_EFF_MASK
+constexpr uint32_t kSffMask = 0x000007FFU;  // CAN_SFF_MASK
+constexpr uint8_t kFDBitRateSwitch = 0x01;  // CANFD_BRS
+constexpr uint8_t kFDErrorState = 0x02;     // CANFD_ESI
+
+uint64_t wallClockNs()
+{
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+QString systemError()
+{
+    return QString::fromLocal8Bit(std::strerror(errno));
+}
+
+// Resolves host:port and returns a socket bound (passive) or connected to it
+int openSocket(const std::string &host, uint16_t port, int type, bool passive, QString &error)
+{
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = type;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    addrinfo *addresses = nullptr;
+    std::string service = std::to_string(port);
+    int status = getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &addresses);
+    if (status != 0) {
+        error = QString("Cannot resolve %1: %2").arg(QString::fromStdString(host), QString::fromLocal8Bit(gai_strerror(status)));
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo *address = addresses; address; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int enable = 1;
+        if (passive) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        }
+        if ((passive ? bind(fd, address->ai_addr, address->ai_addrlen)
+                     : connect(fd, address->ai_addr, address->ai_addrlen)) == 0) {
+            break;
+        }
+        error = QString("Cannot %1 %2 port %3: %4").arg(passive ? "listen on" : "connect to",
+                                                      QString::fromStdString(host.empty() ? "*" : host))
+                    .arg(port).arg(systemError());
+        ::close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    return fd;
+}
+
+// Reads one "< ... >" socketcand message a byte at a time, so nothing that
+// follows it is consumed, and returns its text without the brackets
+bool readMessage(int fd, std::string &message)
+{
+    message.clear();
+    bool inside = false;
+    char c;
+    while (recv(fd, &c, 1, 0) == 1) {
+        if (c == '<') {
+            inside = true;
+            message.clear();
+        } else if (c == '>' && inside) {
+            size_t first = message.find_first_not_of(' ');
+            size_t last = message.find_last_not_of(' ');
+            message = first == std::string::npos ? std::string() : message.substr(first, last - first + 1);
+            return true;
+        } else if (inside) {
+            message += c;
+        }
+    }
+    return false;
+}
+
+bool sendMessage(int fd, const std::string &message)
+{
+    std::string text = "< " + message + " >";
+    return send(fd, text.data(), text.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(text.size());
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Parses "frame ID seconds.fraction DATA" or "error CLASS seconds.fraction
+// [DATA]". Returns false for messages that are not frames, setting malformed
+// when a frame message does not parse.
+bool parseFrameMessage(const char *p, const char *end, LiveFrame &frame, bool &malformed)
+{
+    malformed = false;
+    while (p < end && isSpace(*p)) ++p;
+    const char *word = p;
+    while (p < end && !isSpace(*p)) ++p;
+    std::string_view command(word, static_cast<size_t>(p - word));
+    bool isError = command == "error";
+    if (command != "frame" && !isError) {
+        return false;
+    }
+    malformed = true;
+
+    while (p < end && isSpace(*p)) ++p;
+    const char *idStart = p;
+    uint32_t id = 0;
+    for (uint8_t digit; p < end && (digit = hexDigitValue(*p)) != 0xFF; ++p) {
+        id = (id << 4) | digit;
+    }
+    size_t idDigits = static_cast<size_t>(p - idStart);
+    if (idDigits == 0 || idDigits > 8 || p >= end || !isSpace(*p)) {
+        // "< error text >" replies are not error frames and are ignored
+        malformed = !isError;
+        return false;
+    }
+
+    while (p < end && isSpace(*p)) ++p;
+    uint64_t seconds = 0;
+    const char *secondsStart = p;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        seconds = seconds * 10 + static_cast<uint64_t>(*p - '0');
+    }
+    if (p == secondsStart) {
+        return false;
+    }
+    uint64_t nanos = 0;
+    if (p < end && *p == '.') {
+        ++p;
+        uint64_t scale = 100000000;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            nanos += static_cast<uint64_t>(*p - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    while (p < end && isSpace(*p)) ++p;
+    size_t length = decodeHexRun(p, end, frame.data, sizeof(frame.data));
+    p += length * 2;
+    while (p < end && isSpace(*p)) ++p;
+    if (p != end) {
+        return false;
+    }
+
+    frame.timestampNs = seconds * 1000000000ULL + nanos;
+    frame.flags = 0;
+    if (isError) {
+        frame.flags = FrameError | FrameExtended;
+        frame.id = id & kEffMask;
+    } else if (idDigits > 3) {
+        frame.flags = FrameExtended;
+        frame.id = id & kEffMask;
+    } else {
+        frame.id = id & kSffMask;
+    }
+    if (length > 8) {
+        frame.flags |= FrameFD;
+    }
+    frame.dlc = static_cast<uint8_t>(length);
+    malformed = false;
+    return true;
+}
+}
+
+bool CannelloniReader::open(const std::string &address, uint16_t port, const std::string &interfaceName)
+{
+    if (socketFd >= 0) {
+        ::close(socketFd);
+    }
+    socketFd = openSocket(address, port, SOCK_DGRAM, true, error);
+    if (socketFd < 0) {
+        return false;
+    }
+    int enable = 1;
+    int receiveBuffer = kReceiveBufferBytes;
+    setsockopt(socketFd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+    setsockopt(socketFd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+    names.assign(1, interfaceName);
+    sequenceSeen = false;
+    packetsLost = packetsReordered = packetsMalformed = 0;
+    error.clear();
+    return true;
+}
+
+void CannelloniReader::trackSequence(uint8_t sequence)
+{
+    if (!sequenceSeen) {
+        sequenceSeen = true;
+        nextSequence = static_cast<uint8_t>(sequence + 1);
+        return;
+    }
+
+    // Sequence numbers wrap at 256: up to half of that ahead is a gap,
+    // anything behind is a packet that was counted lost and came late
+    uint8_t ahead = static_cast<uint8_t>(sequence - nextSequence);
+    if (ahead < 128) {
+        packetsLost += ahead;
+        nextSequence = static_cast<uint8_t>(sequence + 1);
+    } else {
+        ++packetsReordered;
+        if (packetsLost > 0) {
+            --packetsLost;
+        }
+    }
+}
+
+bool CannelloniReader::decodePacket(const uint8_t *packet, size_t size, uint64_t timestampNs, LiveFeed &feed)
+{
+    if (size < kCannelloniHeaderBytes || packet[0] != kCannelloniVersion) {
+        return false;
+    }
+    if (packet[1] != kCannelloniData) {
+        return true;  // acknowledgements carry no frames
+    }
+    trackSequence(packet[2]);
+    size_t count = (static_cast<size_t>(packet[3]) << 8) | packet[4];
+
+    const uint8_t *p = packet + kCannelloniHeaderBytes;
+    const uint8_t *end = packet + size;
+    LiveFrame frame;
+    frame.timestampNs = timestampNs;
+    frame.interface = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (end - p < 5) {
+            return false;
+        }
+        uint32_t canId = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+                       | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+        uint8_t length = p[4];
+        p += 5;
+
+        frame.flags = 0;
+        if (canId & kErrFlag) {
+            frame.flags = FrameError | FrameExtended;
+            frame.id = canId & kEffMask;
+        } else if (canId & kEffFlag) {
+            frame.flags = FrameExtended;
+            frame.id = canId & kEffMask;
+        } else {
+            frame.id = canId & kSffMask;
+        }
+
+        if (length & kCannelloniFDFrame) {
+            if (p >= end) {
+                return false;
+            }
+            frame.flags |= FrameFD;
+            if (*p & kFDBitRateSwitch) frame.flags |= FrameBRS;
+            if (*p & kFDErrorState) frame.flags |= FrameESI;
+            ++p;
+            length &= ~kCannelloniFDFrame;
+            if (length > 64) {
+                return false;
+            }
+        } else if (length > 8) {
+            return false;
+        }
+
+        if (canId & kRtrFlag) {
+            // The length field is the requested DLC, no data follows
+            frame.flags |= FrameRemote;
+            frame.dlc = length;
+        } else {
+            if (static_cast<size_t>(end - p) < length) {
+                return false;
+            }
+            std::memcpy(frame.data, p, length);
+            p += length;
+            frame.dlc = length;
+        }
+        feed.push(frame);
+    }
+    return true;
+}
+
+void CannelloniReader::run(LiveFeed &feed, const std::atomic<bool> &stop)
+{
+    constexpr size_t kControlBytes = CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t));
+    std::vector<uint8_t> packets(kBatchPackets * kMaxPacketBytes);
+    std::vector<iovec> vectors(kBatchPackets);
+    std::vector<mmsghdr> messages(kBatchPackets);
+    std::vector<char> control(kBatchPackets * kControlBytes);
+    uint32_t kernelDropCount = 0;
+
+    pollfd polled = {socketFd, POLLIN, 0};
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (poll(&polled, 1, kPollTimeoutMs) <= 0) {
+            continue;
+        }
+
+        int received;
+        do {
+            for (size_t i = 0; i < kBatchPackets; ++i) {
+                vectors[i].iov_base = packets.data() + i * kMaxPacketBytes;
+                vectors[i].iov_len = kMaxPacketBytes;
+                std::memset(&messages[i].msg_hdr, 0, sizeof(msghdr));
+                messages[i].msg_hdr.msg_iov = &vectors[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+                messages[i].msg_hdr.msg_control = control.data() + i * kControlBytes;
+                messages[i].msg_hdr.msg_controllen = kControlBytes;
+            }
+            received = recvmmsg(socketFd, messages.data(), kBatchPackets, MSG_DONTWAIT, nullptr);
+
+            for (int i = 0; i < received; ++i) {
+                msghdr &header = messages[i].msg_hdr;
+                uint64_t timestamp = 0;
+                for (cmsghdr *message = CMSG_FIRSTHDR(&header); message; message = CMSG_NXTHDR(&header, message)) {
+                    if (message->cmsg_level != SOL_SOCKET) {
+                        continue;
+                    }
+                    if (message->cmsg_type == SO_TIMESTAMPNS) {
+                        timespec stamp;
+                        std::memcpy(&stamp, CMSG_DATA(message), sizeof(stamp));
+                        timestamp = static_cast<uint64_t>(stamp.tv_sec) * 1000000000ULL
+                                  + static_cast<uint64_t>(stamp.tv_nsec);
+                    } else if (message->cmsg_type == SO_RXQ_OVFL) {
+                        // Datagrams, not frames, but still a running total
+                        uint32_t dropped;
+                        std::memcpy(&dropped, CMSG_DATA(message), sizeof(dropped));
+                        feed.addKernelDrops(dropped - kernelDropCount);
+                        kernelDropCount = dropped;
+                    }
+                }
+                if (timestamp == 0) {
+                    timestamp = wallClockNs();
+                }
+
+                const uint8_t *packet = packets.data() + i * kMaxPacketBytes;
+                if ((header.msg_flags & MSG_TRUNC) || !decodePacket(packet, messages[i].msg_len, timestamp, feed)) {
+                    ++packetsMalformed;
+                }
+            }
+            feed.setPacketCounts(packetsLost, packetsReordered, packetsMalformed);
+        } while (received == static_cast<int>(kBatchPackets) && !stop.load(std::memory_order_relaxed));
+    }
+}
+
+bool SocketcandReader::open(const std::string &host, uint16_t port, const std::vector<std::string> &buses)
+{
+    close();
+    if (buses.empty() || buses.size() > UINT8_MAX) {
+        error = QString("Between 1 and %1 buses can be captured at once").arg(UINT8_MAX);
+        return false;
+    }
+
+    for (const std::string &bus : buses) {
+        int fd = openSocket(host, port, SOCK_STREAM, false, error);
+        if (fd < 0) {
+            close();
+            return false;
+        }
+        sockets.push_back(fd);
+        int enable = 1;
+        int receiveBuffer = kReceiveBufferBytes;
+        timeval timeout = {kHandshakeTimeoutSeconds, 0};
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        // "< hi >", then open the bus and switch it to raw frames
+        std::string reply;
+        bool greeted = readMessage(fd, reply) && reply == "hi";
+        bool opened = greeted && sendMessage(fd, "open " + bus) && readMessage(fd, reply) && reply == "ok";
+        bool raw = opened && sendMessage(fd, "rawmode") && readMessage(fd, reply) && reply == "ok";
+        if (!raw) {
+            QString step = !greeted ? "is not a socketcand server" : !opened ? "cannot open " : "refused raw mode on ";
+            error = QString("%1:%2 %3%4").arg(QString::fromStdString(host)).arg(port).arg(step)
+                        .arg(greeted ? QString::fromStdString(bus) : QString());
+            if (!reply.empty()) {
+                error += QString(" (%1)").arg(QString::fromStdString(reply));
+            }
+            close();
+            return false;
+        }
+        names.push_back(bus);
+    }
+    messagesMalformed = 0;
+    error.clear();
+    return true;
+}
+
+const char *SocketcandReader::decodeMessages(const char *begin, const char *end, uint8_t interface, LiveFeed &feed)
+{
+    LiveFrame frame;
+    frame.interface = interface;
+    const char *p = begin;
+    for (;;) {
+        const char *open = static_cast<const char *>(std::memchr(p, '<', static_cast<size_t>(end - p)));
+        if (!open) {
+            return end;
+        }
+        const char *closing = static_cast<const char *>(std::memchr(open, '>', static_cast<size_t>(end - open)));
+        if (!closing) {
+            return open;
+        }
+        bool malformed;
+        if (parseFrameMessage(open + 1, closing, frame, malformed)) {
+            feed.push(frame);
+        } else if (malformed) {
+            ++messagesMalformed;
+        }
+        p = closing + 1;
+    }
+}
+
+void SocketcandReader::run(LiveFeed &feed, const std::atomic<bool> &stop)
+{
+    // One receive block per connection; an incomplete message at its end is
+    // moved to the front and completed by the next recv()
+    std::vector<pollfd> polled(sockets.size());
+    std::vector<std::vector<char>> blocks(sockets.size(), std::vector<char>(kReceiveBytes));
+    std::vector<size_t> filled(sockets.size(), 0);
+    for (size_t i = 0; i < sockets.size(); ++i) {
+        polled[i].fd = sockets[i];
+        polled[i].events = POLLIN;
+    }
+
+    size_t connected = sockets.size();
+    while (connected > 0 && !stop.load(std::memory_order_relaxed)) {
+        if (poll(polled.data(), polled.size(), kPollTimeoutMs) <= 0) {
+            continue;
+        }
+
+        for (size_t s = 0; s < polled.size(); ++s) {
+            if (polled[s].revents == 0) {
+                continue;
+            }
+            std::vector<char> &block = blocks[s];
+            ssize_t received = recv(sockets[s], block.data() + filled[s], block.size() - filled[s], MSG_DONTWAIT);
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EINTR)) {
+                // The server went away; a negative fd drops out of poll(), and
+                // the capture ends once no connection is left
+                polled[s].fd = -1;
+                feed.addClosedConnection();
+                --connected;
+                continue;
+            }
+            if (received < 0) {
+                continue;
+            }
+            filled[s] += static_cast<size_t>(received);
+
+            const char *rest = decodeMessages(block.data(), block.data() + filled[s], static_cast<uint8_t>(s), feed);
+            size_t restBytes = static_cast<size_t>(block.data() + filled[s] - rest);
+            if (restBytes == block.size()) {
+                // A whole block without a closing bracket is not socketcand
+                ++messagesMalformed;
+                restBytes = 0;
+            }
+            std::memmove(block.data(), rest, restBytes);
+            filled[s] = restBytes;
+        }
+        feed.setPacketCounts(0, 0, messagesMalformed);
+    }
+}
+
+void SocketcandReader::close()
+{
+    for (int fd : sockets) {
+        ::close(fd);
+    }
+    sockets.clear();
+    names.clear();
+}
+
+#else
+
+bool CannelloniReader::open(const std::string &, uint16_t, const std::string &)
+{
+    error = QString("Network capture is only available on Linux");
+    return false;
+}
+
+void CannelloniReader::run(LiveFeed &, const std::atomic<bool> &)
+{
+}
+
+bool SocketcandReader::open(const std::string &, uint16_t, const std::vector<std::string> &)
+{
+    error = QString("Network capture is only available on Linux");
+    return false;
+}
+
+void SocketcandReader::run(LiveFeed &, const std::atomic<bool> &)
+{
+}
+
+void SocketcandReader::close()
+{
+}
+
+#endif
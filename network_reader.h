@@ -0,0 +1,91 @@
+#ifndef NETWORK_READER_H
+#define NETWORK_READER_H
+#pragma once
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "live_capture.h"
+
+// CAN forwarded over UDP by cannelloni. Every datagram carries a sequence
+// number and a batch of frames; up to kBatchPackets datagrams are taken per
+// recvmmsg() call and decoded straight into the feed. Frames are stamped with
+// the datagram's kernel arrival time, cannelloni sends none. Gaps in the
+// sequence count as lost packets until the missing packet turns up late,
+// when it counts as reordered instead. Linux only.
+class CannelloniReader : public LiveReader
+{
+public:
+    static constexpr uint16_t kDefaultPort = 20000;
+    static constexpr size_t kBatchPackets = 16;
+    static constexpr size_t kMaxPacketBytes = 65536;
+
+    CannelloniReader() = default;
+    ~CannelloniReader() override;
+
+    CannelloniReader(const CannelloniReader &) = delete;
+    CannelloniReader &operator=(const CannelloniReader &) = delete;
+
+    // Listens on address:port (an empty address listens on every interface);
+    // frames appear as interfaceName
+    bool open(const std::string &address, uint16_t port, const std::string &interfaceName);
+    QString errorString() const { return error; }
+
+    const std::vector<std::string> &interfaces() const override { return names; }
+    void run(LiveFeed &feed, const std::atomic<bool> &stop) override;
+
+private:
+    bool decodePacket(const uint8_t *packet, size_t size, uint64_t timestampNs, LiveFeed &feed);
+    void trackSequence(uint8_t sequence);
+
+    int socketFd = -1;
+    std::vector<std::string> names;
+    QString error;
+
+    bool sequenceSeen = false;
+    uint8_t nextSequence = 0;
+    uint64_t packetsLost = 0;
+    uint64_t packetsReordered = 0;
+    uint64_t packetsMalformed = 0;
+};
+
+// CAN forwarded over TCP by socketcand in raw mode, one connection per bus.
+// The "< frame ID seconds.micros DATA >" messages are parsed out of large
+// receive blocks without per-message allocation and keep the server's
+// timestamps. TCP neither loses nor reorders, so only malformed messages are
+// counted. Linux only.
+class SocketcandReader : public LiveReader
+{
+public:
+    static constexpr uint16_t kDefaultPort = 29536;
+    static constexpr size_t kReceiveBytes = 256 * 1024;
+
+    SocketcandReader() = default;
+    ~SocketcandReader() override;
+
+    SocketcandReader(const SocketcandReader &) = delete;
+    SocketcandReader &operator=(const SocketcandReader &) = delete;
+
+    // Connects to host:port once per bus and switches each connection to raw
+    // mode. Returns false with errorString() set if any step fails.
+    bool open(const std::string &host, uint16_t port, const std::vector<std::string> &buses);
+    QString errorString() const { return error; }
+
+    const std::vector<std::string> &interfaces() const override { return names; }
+    void run(LiveFeed &feed, const std::atomic<bool> &stop) override;
+
+private:
+    // Parses the complete messages in [begin, end) into feed and returns
+    // where the first incomplete one starts
+    const char *decodeMessages(const char *begin, const char *end, uint8_t interface, LiveFeed &feed);
+    void close();
+
+    std::vector<int> sockets;
+    std::vector<std::string> names;
+    QString error;
+    uint64_t messagesMalformed = 0;
+};
+
+#endif // NETWORK_READER_H
@@ -0,0 +1,346 @@
+#include "payload_search.h"
+#include "hex_decode.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <thread>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PAYLOAD_SEARCH_X86 1
+#include <immintrin.h>
+#else
+#define PAYLOAD_SEARCH_X86 0
+#endif
+
+namespace {
+
+// Rows of the payload column scanned per call, 512 KB of payload
+constexpr size_t kWindowRows = 64 * 1024;
+// Rows below this are searched on the calling thread
+constexpr size_t kMinRowsPerThread = 4 * kWindowRows;
+
+// The two pattern bytes the vector kernels test first: the first and last
+// fully specified bytes, falling back to any byte with a fixed nibble
+struct Anchors {
+    size_t first = 0;
+    size_t second = 0;
+};
+
+Anchors anchorsOf(const BytePattern &pattern)
+{
+    Anchors anchors;
+    bool anyFull = false;
+    for (size_t i = 0; i < pattern.length; ++i) {
+        if (pattern.mask[i] == 0xFF) {
+            if (!anyFull) {
+                anchors.first = i;
+            }
+            anchors.second = i;
+            anyFull = true;
+        }
+    }
+    if (!anyFull) {
+        while (pattern.mask[anchors.first] == 0) {
+            ++anchors.first;
+        }
+        anchors.second = anchors.first;
+    }
+    return anchors;
+}
+
+void findPatternScalar(const uint8_t *data, size_t size, const BytePattern &pattern, std::vector<uint32_t> &offsets)
+{
+    if (size < pattern.length) {
+        return;
+    }
+    Anchors anchors = anchorsOf(pattern);
+    uint8_t maskA = pattern.mask[anchors.first];
+    uint8_t valueA = pattern.value[anchors.first];
+    for (size_t pos = 0; pos + pattern.length <= size; ++pos) {
+        if ((data[pos + anchors.first] & maskA) == valueA && pattern.matches(data + pos)) {
+            offsets.push_back(static_cast<uint32_t>(pos));
+        }
+    }
+}
+
+#if PAYLOAD_SEARCH_X86
+
+// Both kernels test the two anchor bytes for a whole register of start
+// positions, AND the results and verify only the positions left set
+
+__attribute__((target("sse2")))
+void findPatternSSE2(const uint8_t *data, size_t size, const BytePattern &pattern, std::vector<uint32_t> &offsets)
+{
+    if (size < pattern.length) {
+        return;
+    }
+    Anchors anchors = anchorsOf(pattern);
+    const __m128i maskA = _mm_set1_epi8(static_cast<char>(pattern.mask[anchors.first]));
+    const __m128i valueA = _mm_set1_epi8(static_cast<char>(pattern.value[anchors.first]));
+    const __m128i maskB = _mm_set1_epi8(static_cast<char>(pattern.mask[anchors.second]));
+    const __m128i valueB = _mm_set1_epi8(static_cast<char>(pattern.value[anchors.second]));
+
+    size_t starts = size - pattern.length + 1;
+    size_t pos = 0;
+    for (; pos + 16 <= starts; pos += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos + anchors.first));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos + anchors.second));
+        __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(a, maskA), valueA),
+                                     _mm_cmpeq_epi8(_mm_and_si128(b, maskB), valueB));
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        while (bits) {
+            size_t candidate = pos + static_cast<size_t>(std::countr_zero(bits));
+            if (pattern.matches(data + candidate)) {
+                offsets.push_back(static_cast<uint32_t>(candidate));
+            }
+            bits &= bits - 1;
+        }
+    }
+    for (; pos < starts; ++pos) {
+        if (pattern.matches(data + pos)) {
+            offsets.push_back(static_cast<uint32_t>(pos));
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void findPatternAVX2(const uint8_t *data, size_t size, const BytePattern &pattern, std::vector<uint32_t> &offsets)
+{
+    if (size < pattern.length) {
+        return;
+    }
+    Anchors anchors = anchorsOf(pattern);
+    const __m256i maskA = _mm256_set1_epi8(static_cast<char>(pattern.mask[anchors.first]));
+    const __m256i valueA = _mm256_set1_epi8(static_cast<char>(pattern.value[anchors.first]));
+    const __m256i maskB = _mm256_set1_epi8(static_cast<char>(pattern.mask[anchors.second]));
+    const __m256i valueB = _mm256_set1_epi8(static_cast<char>(pattern.value[anchors.second]));
+
+    size_t starts = size - pattern.length + 1;
+    size_t pos = 0;
+    for (; pos + 32 <= starts; pos += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos + anchors.first));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos + anchors.second));
+        __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(a, maskA), valueA),
+                                        _mm256_cmpeq_epi8(_mm256_and_si256(b, maskB), valueB));
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        while (bits) {
+            size_t candidate = pos + static_cast<size_t>(std::countr_zero(bits));
+            if (pattern.matches(data + candidate)) {
+                offsets.push_back(static_cast<uint32_t>(candidate));
+            }
+            bits &= bits - 1;
+        }
+    }
+    for (; pos < starts; ++pos) {
+        if (pattern.matches(data + pos)) {
+            offsets.push_back(static_cast<uint32_t>(pos));
+        }
+    }
+}
+
+#endif // PAYLOAD_SEARCH_X86
+
+using SearchFn = void (*)(const uint8_t *, size_t, const BytePattern &, std::vector<uint32_t> &);
+
+SearchFn selectKernel()
+{
+#if PAYLOAD_SEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return findPatternAVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return findPatternSSE2;
+    }
+#endif
+    return findPatternScalar;
+}
+
+SearchFn kernel()
+{
+    static const SearchFn selected = selectKernel();
+    return selected;
+}
+
+size_t workerCount(int threads, size_t items, size_t minItemsPerWorker)
+{
+    size_t workers = threads > 0 ? static_cast<size_t>(threads)
+                                 : std::max<size_t>(1, std::thread::hardware_concurrency());
+    return std::max<size_t>(1, std::min(workers, items / std::max<size_t>(1, minItemsPerWorker)));
+}
+
+// Rows in [firstRow, lastRow) with a match inside their own payload
+void searchRows(const CANFrameStore &store, const BytePattern &pattern, size_t firstRow, size_t lastRow,
+                std::vector<uint32_t> &rows)
+{
+    const uint8_t *dlcs = store.dlcs().data();
+    const uint8_t *flags = store.flagColumn().data();
+    std::vector<uint32_t> offsets;
+
+    // Classic frames: one scan over the zero-padded payload column, keeping
+    // matches that lie inside a single frame's DLC
+    if (pattern.length <= CANFrameStore::kPayloadStride) {
+        const uint8_t *payloads = store.payloads().data();
+        for (size_t window = firstRow; window < lastRow; window += kWindowRows) {
+            size_t windowEnd = std::min(lastRow, window + kWindowRows);
+            offsets.clear();
+            kernel()(payloads + window * CANFrameStore::kPayloadStride,
+                     (windowEnd - window) * CANFrameStore::kPayloadStride, pattern, offsets);
+            for (uint32_t offset : offsets) {
+                size_t row = window + offset / CANFrameStore::kPayloadStride;
+                size_t start = offset % CANFrameStore::kPayloadStride;
+                uint8_t dlc = dlcs[row];
+                if (dlc <= CANFrameStore::kPayloadStride && start + pattern.length <= dlc
+                    && !(flags[row] & FrameRemote) && (rows.empty() || rows.back() != row)) {
+                    rows.push_back(static_cast<uint32_t>(row));
+                }
+            }
+        }
+    }
+
+    // Long FD frames keep their payload in the store's side table
+    std::vector<uint32_t> fdRows;
+    for (size_t row = firstRow; row < lastRow; ++row) {
+        if (dlcs[row] > CANFrameStore::kPayloadStride) {
+            offsets.clear();
+            kernel()(store.payload(row), dlcs[row], pattern, offsets);
+            if (!offsets.empty()) {
+                fdRows.push_back(static_cast<uint32_t>(row));
+            }
+        }
+    }
+    if (!fdRows.empty()) {
+        size_t classic = rows.size();
+        rows.insert(rows.end(), fdRows.begin(), fdRows.end());
+        std::inplace_merge(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(classic), rows.end());
+    }
+}
+
+// Rows where a match starts in the concatenated payloads of each key
+void searchStreams(const CANFrameStore &store, const CANIDIndex &idIndex, const BytePattern &pattern,
+                   std::atomic<size_t> &nextKey, std::vector<uint32_t> &rows)
+{
+    const std::vector<uint32_t> &keys = idIndex.keys();
+    std::vector<uint8_t> stream;
+    std::vector<uint32_t> streamStarts;  // offset of each frame in stream
+    std::vector<uint32_t> streamRows;
+    std::vector<uint32_t> offsets;
+
+    for (size_t k = nextKey++; k < keys.size(); k = nextKey++) {
+        stream.clear();
+        streamStarts.clear();
+        streamRows.clear();
+        for (uint32_t row : *idIndex.rows(keys[k])) {
+            if (store.flags(row) & FrameRemote) {
+                continue;
+            }
+            const uint8_t *payload = store.payload(row);
+            streamStarts.push_back(static_cast<uint32_t>(stream.size()));
+            streamRows.push_back(row);
+            stream.insert(stream.end(), payload, payload + store.dlc(row));
+        }
+
+        offsets.clear();
+        kernel()(stream.data(), stream.size(), pattern, offsets);
+        for (uint32_t offset : offsets) {
+            auto frame = std::upper_bound(streamStarts.begin(), streamStarts.end(), offset) - 1;
+            uint32_t row = streamRows[static_cast<size_t>(frame - streamStarts.begin())];
+            if (rows.empty() || rows.back() != row) {
+                rows.push_back(row);
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool BytePattern::parse(std::string_view text, BytePattern &pattern, std::string &error)
+{
+    pattern = BytePattern();
+    size_t nibbles = 0;
+    bool anyFixed = false;
+    for (char c : text) {
+        if (c == ' ' || c == '\t' || c == ':' || c == '-') {
+            continue;
+        }
+        uint8_t digit = hexDigitValue(c);
+        if (c != '?' && digit == 0xFF) {
+            error = std::string("'") + c + "' is neither a hex digit nor '?'";
+            return false;
+        }
+        if (nibbles / 2 >= kMaxLength) {
+            error = "Patterns are limited to " + std::to_string(kMaxLength) + " bytes";
+            return false;
+        }
+        size_t byte = nibbles / 2;
+        int shift = nibbles % 2 == 0 ? 4 : 0;
+        if (c != '?') {
+            pattern.value[byte] |= static_cast<uint8_t>(digit << shift);
+            pattern.mask[byte] |= static_cast<uint8_t>(0x0F << shift);
+            anyFixed = true;
+        }
+        ++nibbles;
+    }
+
+    if (nibbles == 0 || nibbles % 2 != 0) {
+        error = "Enter whole bytes as pairs of hex digits, '?' for any nibble";
+        return false;
+    }
+    if (!anyFixed) {
+        error = "The pattern needs at least one hex digit";
+        return false;
+    }
+    pattern.length = nibbles / 2;
+    return true;
+}
+
+void findPattern(const uint8_t *data, size_t size, const BytePattern &pattern, std::vector<uint32_t> &offsets)
+{
+    kernel()(data, size, pattern, offsets);
+}
+
+std::vector<uint32_t> searchPayloads(const CANFrameStore &store, const CANIDIndex &idIndex,
+                                     const BytePattern &pattern, bool spanFrames, int threads)
+{
+    if (pattern.length == 0 || store.empty()) {
+        return {};
+    }
+
+    std::vector<std::vector<uint32_t>> partial;
+    std::vector<std::thread> pool;
+    if (spanFrames) {
+        // IDs are handed out one at a time, a busy ID costs more than a rare one
+        std::atomic<size_t> nextKey{0};
+        size_t workers = workerCount(threads, idIndex.keys().size(), 1);
+        partial.resize(workers);
+        for (size_t w = 1; w < workers; ++w) {
+            pool.emplace_back(searchStreams, std::cref(store), std::cref(idIndex), std::cref(pattern),
+                              std::ref(nextKey), std::ref(partial[w]));
+        }
+        searchStreams(store, idIndex, pattern, nextKey, partial[0]);
+    } else {
+        // Contiguous row ranges keep every worker's rows ascending
+        size_t rows = store.size();
+        size_t workers = workerCount(threads, rows, kMinRowsPerThread);
+        partial.resize(workers);
+        for (size_t w = 1; w < workers; ++w) {
+            pool.emplace_back(searchRows, std::cref(store), std::cref(pattern), rows * w / workers,
+                              rows * (w + 1) / workers, std::ref(partial[w]));
+        }
+        searchRows(store, pattern, 0, rows / workers, partial[0]);
+    }
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    std::vector<uint32_t> hits;
+    for (const std::vector<uint32_t> &part : partial) {
+        hits.insert(hits.end(), part.begin(), part.end());
+    }
+    if (spanFrames) {
+        std::sort(hits.begin(), hits.end());
+    }
+    return hits;
+}
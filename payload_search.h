@@ -0,0 +1,51 @@
+#ifndef PAYLOAD_SEARCH_H
+#define PAYLOAD_SEARCH_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "can_id_index.h"
+#include "frame_store.h"
+
+// Byte sequence to look for in payloads. Any nibble may be a '?' wildcard,
+// so "DE AD ?? B?" matches DE AD 00 B0 as well as DE AD FF BF.
+struct BytePattern {
+    static constexpr size_t kMaxLength = 64;
+
+    uint8_t value[kMaxLength] = {};
+    uint8_t mask[kMaxLength] = {};   // 0xF0/0x0F/0xFF per byte, 0 for "??"
+    size_t length = 0;
+
+    // Reads hex digits and '?', ignoring spaces, ':' and '-'. Returns false
+    // and sets error for odd digit counts, unknown characters or a pattern
+    // made only of wildcards.
+    static bool parse(std::string_view text, BytePattern &pattern, std::string &error);
+
+    bool matches(const uint8_t *data) const
+    {
+        for (size_t i = 0; i < length; ++i) {
+            if ((data[i] & mask[i]) != value[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Start offsets of every match of pattern in data[0, size), ascending.
+// memmem-style scan: two anchor bytes are compared 32 (AVX2) or 16 (SSE2)
+// positions at a time and only the candidates are checked in full.
+void findPattern(const uint8_t *data, size_t size, const BytePattern &pattern, std::vector<uint32_t> &offsets);
+
+// Ascending rows whose payload contains pattern. With spanFrames, the
+// payloads of each ID are searched as one stream in row order so a match
+// may continue into the ID's next frames; the row where it starts is
+// reported. Remote frames have no payload and never match.
+// threads <= 0 uses every core.
+std::vector<uint32_t> searchPayloads(const CANFrameStore &store, const CANIDIndex &idIndex,
+                                     const BytePattern &pattern, bool spanFrames, int threads = 0);
+
+#endif // PAYLOAD_SEARCH_H
@@ -0,0 +1,85 @@
+#include "playback_scheduler.h"
+
+#include <algorithm>
+
+void PlaybackScheduler::setSpeed(double speed, Clock::time_point now)
+{
+    // Re-anchor so the new speed applies from here on, not retroactively
+    anchorLogNs = logTime(now);
+    anchorWall = now;
+    playbackSpeed = std::max(speed, 0.0);
+}
+
+void PlaybackScheduler::setReverse(bool backwards, Clock::time_point now)
+{
+    anchorLogNs = logTime(now);
+    anchorWall = now;
+    reverse = backwards;
+}
+
+void PlaybackScheduler::start(uint64_t logTimeNs, Clock::time_point now)
+{
+    running = true;
+    seek(logTimeNs, now);
+}
+
+void PlaybackScheduler::stop()
+{
+    running = false;
+}
+
+void PlaybackScheduler::seek(uint64_t logTimeNs, Clock::time_point now)
+{
+    anchorLogNs = logTimeNs;
+    anchorWall = now;
+}
+
+uint64_t PlaybackScheduler::logTime(Clock::time_point now) const
+{
+    if (!running || isUnlimited() || now <= anchorWall) {
+        return anchorLogNs;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - anchorWall).count();
+    uint64_t played = static_cast<uint64_t>(static_cast<double>(elapsed) * playbackSpeed);
+    if (reverse) {
+        return played < anchorLogNs ? anchorLogNs - played : 0;
+    }
+    return anchorLogNs + played;
+}
+
+size_t PlaybackScheduler::dueRows(const CANFrameStore &store, const TimeIndex &index, size_t nextRow,
+                                  Clock::time_point now)
+{
+    if (!running || nextRow >= store.size()) {
+        return nextRow;
+    }
+
+    if (isUnlimited()) {
+        size_t end = std::min(store.size(), nextRow + kMaxBatchRows);
+        seek(store.timestamp(end - 1), now);
+        return end;
+    }
+
+    // Every row stamped at or before the current log time is due
+    uint64_t due = logTime(now);
+    size_t end = due == UINT64_MAX ? store.size() : index.findRow(store, due + 1);
+    return std::max(end, nextRow);
+}
+
+size_t PlaybackScheduler::dueRowsReverse(const CANFrameStore &store, const TimeIndex &index, size_t endRow,
+                                         Clock::time_point now)
+{
+    endRow = std::min(endRow, store.size());
+    if (!running || endRow == 0) {
+        return endRow;
+    }
+
+    if (isUnlimited()) {
+        size_t start = endRow - std::min(endRow, kMaxBatchRows);
+        seek(store.timestamp(start), now);
+        return start;
+    }
+
+    // Every row stamped at or after the current log time is due
+    return std::min(index.findRow(store, logTime(now)), endRow);
+}
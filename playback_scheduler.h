@@ -0,0 +1,63 @@
+#ifndef PLAYBACK_SCHEDULER_H
+#define PLAYBACK_SCHEDULER_H
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "frame_store.h"
+#include "time_index.h"
+
+// Maps a monotonic wall clock onto log time for playback, forwards or in
+// reverse. Log time is always worked out from one anchor (a wall time and the
+// log time it stood for), so however irregular the ticks are, playback never
+// drifts; a late tick simply gets a bigger batch of due frames. Changing
+// speed or direction or seeking moves the anchor to the current position.
+class PlaybackScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Speed that delivers frames as fast as the caller takes them, in batches
+    // of at most kMaxBatchRows, regardless of their timestamps
+    static constexpr double kAsFastAsPossible = 0.0;
+    static constexpr size_t kMaxBatchRows = 65536;
+
+    void setSpeed(double speed, Clock::time_point now = Clock::now());
+    double speed() const { return playbackSpeed; }
+    bool isUnlimited() const { return playbackSpeed == kAsFastAsPossible; }
+
+    void setReverse(bool reverse, Clock::time_point now = Clock::now());
+    bool isReverse() const { return reverse; }
+
+    void start(uint64_t logTimeNs, Clock::time_point now = Clock::now());
+    void stop();
+    bool isRunning() const { return running; }
+
+    // Continues from logTimeNs, running or not
+    void seek(uint64_t logTimeNs, Clock::time_point now = Clock::now());
+
+    // Log time due at now
+    uint64_t logTime(Clock::time_point now = Clock::now()) const;
+
+    // End of the batch of rows due at now, starting at nextRow: every row in
+    // [nextRow, result) is to be delivered. Unlimited playback takes the
+    // next kMaxBatchRows rows and moves log time to the last of them.
+    size_t dueRows(const CANFrameStore &store, const TimeIndex &index, size_t nextRow,
+                   Clock::time_point now = Clock::now());
+
+    // Reverse counterpart of dueRows(): start of the batch due at now that
+    // ends before endRow, so rows [result, endRow) are to be delivered, the
+    // later ones first
+    size_t dueRowsReverse(const CANFrameStore &store, const TimeIndex &index, size_t endRow,
+                          Clock::time_point now = Clock::now());
+
+private:
+    double playbackSpeed = 1.0;
+    bool running = false;
+    bool reverse = false;
+    Clock::time_point anchorWall;
+    uint64_t anchorLogNs = 0;
+};
+
+#endif // PLAYBACK_SCHEDULER_H
@@ -0,0 +1,40 @@
+#include "scrub_bar.h"
+
+#include <QMouseEvent>
+#include <algorithm>
+
+ScrubBar::ScrubBar(QWidget *parent)
+    : QProgressBar(parent)
+{
+    setRange(0, kResolution);
+    setCursor(Qt::PointingHandCursor);
+}
+
+void ScrubBar::setFraction(double fraction)
+{
+    setValue(static_cast<int>(std::clamp(fraction, 0.0, 1.0) * kResolution));
+}
+
+void ScrubBar::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        scrubTo(event);
+    }
+}
+
+void ScrubBar::mouseMoveEvent(QMouseEvent *event)
+{
+    if (event->buttons() & Qt::LeftButton) {
+        scrubTo(event);
+    }
+}
+
+void ScrubBar::scrubTo(QMouseEvent *event)
+{
+    if (width() <= 0) {
+        return;
+    }
+    double fraction = std::clamp(event->position().x() / width(), 0.0, 1.0);
+    setFraction(fraction);
+    emit scrubbed(fraction);
+}
@@ -0,0 +1,34 @@
+#ifndef SCRUB_BAR_H
+#define SCRUB_BAR_H
+#pragma once
+
+#include <QProgressBar>
+
+class QMouseEvent;
+
+// Progress bar that doubles as a playback scrubber: clicking or dragging on
+// it reports the position as a fraction of its width.
+class ScrubBar : public QProgressBar
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kResolution = 1000;
+
+    explicit ScrubBar(QWidget *parent = nullptr);
+
+    // Shows fraction (0..1) of the bar as filled
+    void setFraction(double fraction);
+
+signals:
+    void scrubbed(double fraction);
+
+protected:
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    void scrubTo(QMouseEvent *event);
+};
+
+#endif // SCRUB_BAR_H
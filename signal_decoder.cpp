@@ -0,0 +1,78 @@
+#include "signal_decoder.h"
+
+SignalPlan SignalPlan::compile(const DBCSignal &signal)
+{
+    SignalPlan plan;
+    plan.bigEndian = signal.bigEndian;
+    plan.factor = signal.factor;
+    plan.offset = signal.offset;
+    if (signal.multiplex == DBCSignal::Multiplex::Multiplexed) {
+        plan.multiplexValue = static_cast<int>(signal.multiplexValue);
+    }
+
+    unsigned length = signal.length;
+    if (length == 0 || length > 64) {
+        plan.supported = false;
+        return plan;
+    }
+    plan.mask = length == 64 ? UINT64_MAX : (uint64_t(1) << length) - 1;
+    plan.signBit = signal.isSigned ? uint64_t(1) << (length - 1) : 0;
+
+    unsigned firstByte;  // lowest payload byte the signal touches
+    unsigned lastByte;   // highest payload byte the signal touches
+    if (!signal.bigEndian) {
+        // Intel: start bit is the LSB, the signal grows towards higher bytes.
+        // Load eight bytes starting at the LSB's byte.
+        firstByte = signal.startBit / 8;
+        lastByte = (signal.startBit + length - 1) / 8;
+        plan.window = static_cast<uint8_t>(MessageDecoder::kPadding + firstByte);
+        plan.shift = static_cast<uint8_t>(signal.startBit % 8);
+        plan.wordShift = static_cast<uint8_t>(signal.startBit % 64);
+    } else {
+        // Motorola: start bit is the MSB in sawtooth numbering. Counting bits
+        // from the MSB of byte 0 makes the signal a contiguous run; load the
+        // eight bytes ending at the LSB's byte and swap them.
+        unsigned msb = (signal.startBit / 8) * 8 + (7 - signal.startBit % 8);
+        unsigned lsb = msb + length - 1;
+        firstByte = msb / 8;
+        lastByte = lsb / 8;
+        plan.window = static_cast<uint8_t>(MessageDecoder::kPadding + lastByte - 7);
+        plan.shift = static_cast<uint8_t>(7 - lsb % 8);
+        plan.wordShift = static_cast<uint8_t>(63 - lsb % 64);
+    }
+
+    plan.minLength = static_cast<uint8_t>(lastByte + 1);
+    if (lastByte >= 64 || plan.shift + length > 64 || lastByte - firstByte >= 8) {
+        plan.supported = false;
+    }
+    plan.fitsWord = plan.supported && lastByte < 8;
+    return plan;
+}
+
+MessageDecoder::MessageDecoder(const DBCMessage &message)
+    : messageName(message.name)
+    , definitions(message.messageSignals)
+{
+    plans.reserve(definitions.size());
+    for (size_t i = 0; i < definitions.size(); ++i) {
+        plans.push_back(SignalPlan::compile(definitions[i]));
+        if (definitions[i].multiplex == DBCSignal::Multiplex::Multiplexor) {
+            multiplexor = static_cast<int>(i);
+        }
+    }
+}
+
+void MessageDecoder::decode(const uint8_t *payload, uint8_t length, double *values, bool *present) const
+{
+    uint8_t buffer[kBufferSize];
+    pad(payload, length, buffer);
+
+    int64_t selector = multiplexor >= 0 ? plans[multiplexor].raw(buffer) : 0;
+    for (size_t i = 0; i < plans.size(); ++i) {
+        const SignalPlan &plan = plans[i];
+        values[i] = plan.physical(buffer);
+        present[i] = plan.supported && length >= plan.minLength
+                  && (plan.multiplexValue == SignalPlan::kNoMultiplex
+                      || (multiplexor >= 0 && selector == plan.multiplexValue));
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef SIGNAL_DECODER_H
+#define SIGNAL_DECODER_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "dbc_handler.h"
+
+// Where one signal sits in a frame, worked out once from its DBC definition.
+// The payload is copied into a zero-padded buffer (see MessageDecoder) so a
+// signal is always one unaligned 8-byte load, an optional byte swap, a shift
+// and a mask, with no per-bit loop and no branches on the layout.
+struct SignalPlan {
+    static constexpr int kNoMultiplex = -1;
+
+    uint8_t window = 0;       // offset of the 8-byte load in the padded buffer
+    uint8_t shift = 0;        // right shift putting the signal's LSB at bit 0
+    bool bigEndian = false;   // load is byte swapped first
+    bool supported = true;    // false for signals wider than one 8-byte window
+    uint8_t minLength = 0;    // payload bytes needed for the signal to be present
+    bool fitsWord = false;    // lies in the first 8 payload bytes
+    uint8_t wordShift = 0;    // right shift for fromWord()
+    uint64_t mask = 0;
+    uint64_t signBit = 0;     // top bit of signed signals, 0 for unsigned
+    double factor = 1.0;
+    double offset = 0.0;
+    int multiplexValue = kNoMultiplex;  // multiplexor value this signal needs
+
+    static SignalPlan compile(const DBCSignal &signal);
+
+    // Raw bits of the signal, sign extended, from a padded payload buffer
+    int64_t raw(const uint8_t *padded) const
+    {
+        uint64_t word;
+        std::memcpy(&word, padded + window, sizeof(word));
+        if (bigEndian) {
+            word = __builtin_bswap64(word);
+        }
+        uint64_t bits = (word >> shift) & mask;
+        return static_cast<int64_t>((bits ^ signBit) - signBit);
+    }
+
+    // Same as raw(), from the first 8 payload bytes as one little-endian
+    // word; only valid when fitsWord
+    int64_t fromWord(uint64_t word) const
+    {
+        if (bigEndian) {
+            word = __builtin_bswap64(word);
+        }
+        uint64_t bits = (word >> wordShift) & mask;
+        return static_cast<int64_t>((bits ^ signBit) - signBit);
+    }
+
+    double physical(const uint8_t *padded) const
+    {
+        return static_cast<double>(raw(padded)) * factor + offset;
+    }
+};
+
+// Compiled decoder for every signal of one DBC message
+class MessageDecoder
+{
+public:
+    // Payload bytes go at kPadding in a buffer of kBufferSize zeroed bytes,
+    // so every signal window stays inside the buffer
+    static constexpr size_t kPadding = 8;
+    static constexpr size_t kBufferSize = kPadding + 64 + 8;
+
+    MessageDecoder() = default;
+    explicit MessageDecoder(const DBCMessage &message);
+
+    const std::string &name() const { return messageName; }
+    size_t signalCount() const { return plans.size(); }
+    const DBCSignal &signal(size_t index) const { return definitions[index]; }
+    const SignalPlan &plan(size_t index) const { return plans[index]; }
+    int multiplexorIndex() const { return multiplexor; }
+
+    // Copies payload into buffer (kBufferSize bytes) in the padded layout
+    static void pad(const uint8_t *payload, uint8_t length, uint8_t *buffer)
+    {
+        std::memset(buffer, 0, kBufferSize);
+        std::memcpy(buffer + kPadding, payload, length);
+    }
+
+    // Decodes every signal into values; present[i] is false when signal i
+    // lies past the payload or belongs to another multiplexor value
+    void decode(const uint8_t *payload, uint8_t length, double *values, bool *present) const;
+
+private:
+    std::string messageName;
+    std::vector<DBCSignal> definitions;
+    std::vector<SignalPlan> plans;
+    int multiplexor = -1;
+};
+
+#endif // SIGNAL_DECODER_H
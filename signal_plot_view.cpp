@@ -0,0 +1,181 @@
+#include "signal_plot_view.h"
+
+#include <QChart>
+#include <QList>
+#include <QMouseEvent>
+#include <QPointF>
+#include <QResizeEvent>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Narrowest range the view zooms into
+constexpr uint64_t kMinimumSpanNs = 1000;
+// Range kept per notch of the mouse wheel
+constexpr double kZoomStep = 0.8;
+}
+
+SignalPlotView::SignalPlotView(QWidget *parent)
+    : QChartView(parent)
+    , series(new QLineSeries)
+    , axisX(new QValueAxis)
+    , axisY(new QValueAxis)
+{
+    QChart *plot = new QChart;
+    plot->legend()->hide();
+    plot->addSeries(series);
+    axisX->setTitleText("Time (s)");
+    plot->addAxis(axisX, Qt::AlignBottom);
+    plot->addAxis(axisY, Qt::AlignLeft);
+    series->attachAxis(axisX);
+    series->attachAxis(axisY);
+    setChart(plot);
+    setRubberBand(QChartView::NoRubberBand);
+}
+
+void SignalPlotView::setPyramid(const SignalPyramid *newPyramid, const QString &title)
+{
+    pyramid = newPyramid;
+    chart()->setTitle(title);
+    resetZoom();
+}
+
+void SignalPlotView::refresh()
+{
+    if (showingAll) {
+        resetZoom();
+    } else {
+        updateSeries();
+    }
+}
+
+void SignalPlotView::resetZoom()
+{
+    showingAll = true;
+    if (pyramid && !pyramid->empty()) {
+        viewFromNs = pyramid->firstTimestamp();
+        viewToNs = std::max(pyramid->lastTimestamp(), viewFromNs + kMinimumSpanNs);
+    } else {
+        viewFromNs = viewToNs = 0;
+    }
+    updateSeries();
+}
+
+void SignalPlotView::setRange(uint64_t fromNs, uint64_t toNs)
+{
+    if (!pyramid || pyramid->empty()) {
+        return;
+    }
+    uint64_t first = pyramid->firstTimestamp();
+    uint64_t last = std::max(pyramid->lastTimestamp(), first + kMinimumSpanNs);
+    uint64_t span = std::clamp(toNs - fromNs, kMinimumSpanNs, last - first);
+
+    // Keep the span and slide it back inside the samples
+    fromNs = std::clamp(fromNs, first, last - span);
+    viewFromNs = fromNs;
+    viewToNs = fromNs + span;
+    showingAll = viewFromNs == first && viewToNs == last;
+    updateSeries();
+}
+
+void SignalPlotView::wheelEvent(QWheelEvent *event)
+{
+    QRectF area = chart()->plotArea();
+    if (!pyramid || pyramid->empty() || area.width() <= 0) {
+        return;
+    }
+
+    // Zoom about the time under the cursor
+    double steps = event->angleDelta().y() / 120.0;
+    double at = std::clamp((event->position().x() - area.left()) / area.width(), 0.0, 1.0);
+    double span = static_cast<double>(viewToNs - viewFromNs);
+    double newSpan = std::max(span * std::pow(kZoomStep, steps), static_cast<double>(kMinimumSpanNs));
+    double anchor = static_cast<double>(viewFromNs) + at * span;
+    double from = std::max(0.0, anchor - at * newSpan);
+    setRange(static_cast<uint64_t>(from), static_cast<uint64_t>(from + newSpan));
+    event->accept();
+}
+
+void SignalPlotView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        dragging = true;
+        dragOrigin = event->pos();
+        dragFromNs = viewFromNs;
+        dragToNs = viewToNs;
+        event->accept();
+        return;
+    }
+    QChartView::mousePressEvent(event);
+}
+
+void SignalPlotView::mouseMoveEvent(QMouseEvent *event)
+{
+    QRectF area = chart()->plotArea();
+    if (!dragging || area.width() <= 0) {
+        QChartView::mouseMoveEvent(event);
+        return;
+    }
+
+    // Dragging right moves the view back in time
+    double span = static_cast<double>(dragToNs - dragFromNs);
+    double shift = (event->pos().x() - dragOrigin.x()) / area.width() * span;
+    double from = std::max(0.0, static_cast<double>(dragFromNs) - shift);
+    setRange(static_cast<uint64_t>(from), static_cast<uint64_t>(from) + (dragToNs - dragFromNs));
+    event->accept();
+}
+
+void SignalPlotView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (dragging && event->button() == Qt::LeftButton) {
+        dragging = false;
+        event->accept();
+        return;
+    }
+    QChartView::mouseReleaseEvent(event);
+}
+
+void SignalPlotView::resizeEvent(QResizeEvent *event)
+{
+    QChartView::resizeEvent(event);
+    updateSeries();
+}
+
+double SignalPlotView::secondsOf(uint64_t timeNs) const
+{
+    uint64_t first = pyramid ? pyramid->firstTimestamp() : 0;
+    return timeNs >= first ? static_cast<double>(timeNs - first) * 1e-9 : 0.0;
+}
+
+void SignalPlotView::updateSeries()
+{
+    if (!pyramid || pyramid->empty()) {
+        series->clear();
+        axisX->setRange(0.0, 1.0);
+        axisY->setRange(0.0, 1.0);
+        return;
+    }
+
+    // About one min/max pair per horizontal pixel of the plot
+    size_t pixels = static_cast<size_t>(std::max(1.0, chart()->plotArea().width()));
+    pyramid->query(viewFromNs, viewToNs, pixels, points);
+
+    QList<QPointF> visible;
+    visible.reserve(static_cast<qsizetype>(points.size()));
+    double low = 0.0;
+    double high = 0.0;
+    for (const SignalPyramid::Point &point : points) {
+        if (visible.isEmpty()) {
+            low = high = point.value;
+        }
+        low = std::min(low, point.value);
+        high = std::max(high, point.value);
+        visible.append(QPointF(secondsOf(point.timeNs), point.value));
+    }
+    series->replace(visible);
+
+    double margin = high > low ? (high - low) * 0.05 : 1.0;
+    axisX->setRange(secondsOf(viewFromNs), secondsOf(viewToNs));
+    axisY->setRange(low - margin, high + margin);
+}
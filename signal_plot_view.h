@@ -0,0 +1,58 @@
+#ifndef SIGNAL_PLOT_VIEW_H
+#define SIGNAL_PLOT_VIEW_H
+#pragma once
+
+#include <QChartView>
+#include <QLineSeries>
+#include <QPoint>
+#include <QValueAxis>
+#include <cstdint>
+#include <vector>
+#include "signal_pyramid.h"
+
+// Time-series chart of one SignalPyramid. The series only ever holds the
+// points of the visible range at about one min/max pair per pixel, taken
+// again from the pyramid whenever the view is zoomed (mouse wheel), panned
+// (drag) or resized. Times on the axis are seconds from the first sample.
+class SignalPlotView : public QChartView
+{
+    Q_OBJECT
+
+public:
+    explicit SignalPlotView(QWidget *parent = nullptr);
+
+    // Shows pyramid (may be null) zoomed out to its full range
+    void setPyramid(const SignalPyramid *pyramid, const QString &title);
+    // Call after the pyramid grew; a fully zoomed out view follows new samples
+    void refresh();
+    void resetZoom();
+
+protected:
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void setRange(uint64_t fromNs, uint64_t toNs);
+    void updateSeries();
+    double secondsOf(uint64_t timeNs) const;
+
+    const SignalPyramid *pyramid = nullptr;
+    QLineSeries *series;
+    QValueAxis *axisX;
+    QValueAxis *axisY;
+    std::vector<SignalPyramid::Point> points;
+
+    uint64_t viewFromNs = 0;
+    uint64_t viewToNs = 0;
+    bool showingAll = true;
+
+    bool dragging = false;
+    QPoint dragOrigin;
+    uint64_t dragFromNs = 0;
+    uint64_t dragToNs = 0;
+};
+
+#endif // SIGNAL_PLOT_VIEW_H
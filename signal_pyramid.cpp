@@ -0,0 +1,149 @@
+#include "signal_pyramid.h"
+
+#include <algorithm>
+#include <numeric>
+
+void SignalPyramid::clear()
+{
+    times.clear();
+    values.clear();
+    levels.clear();
+}
+
+void SignalPyramid::append(const uint64_t *timesNs, const double *newValues, size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    size_t oldSize = times.size();
+    bool ordered = (times.empty() || timesNs[0] >= times.back()) && std::is_sorted(timesNs, timesNs + count);
+    times.insert(times.end(), timesNs, timesNs + count);
+    values.insert(values.end(), newValues, newValues + count);
+    if (ordered) {
+        rebuildLevels(oldSize);
+        return;
+    }
+
+    // Out of order samples (a log not sorted yet) are merged by time
+    std::vector<size_t> order(times.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return times[a] < times[b]; });
+    std::vector<uint64_t> sortedTimes(order.size());
+    std::vector<double> sortedValues(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        sortedTimes[i] = times[order[i]];
+        sortedValues[i] = values[order[i]];
+    }
+    times.swap(sortedTimes);
+    values.swap(sortedValues);
+    rebuildLevels(0);
+}
+
+void SignalPyramid::rebuildLevels(size_t firstSample)
+{
+    // Only buckets covering firstSample onwards change; the last bucket of
+    // each level may have been partial before
+    size_t start = firstSample / kFanout;
+    for (size_t level = 0;; ++level) {
+        size_t below = level == 0 ? times.size() : levels[level - 1].size();
+        if (level > 0 && below <= kFanout) {
+            levels.resize(level);
+            break;
+        }
+        if (level == levels.size()) {
+            levels.emplace_back();
+        }
+
+        std::vector<Bucket> &buckets = levels[level];
+        buckets.resize((below + kFanout - 1) / kFanout);
+        for (size_t b = start; b < buckets.size(); ++b) {
+            size_t first = b * kFanout;
+            size_t last = std::min(first + kFanout, below);
+            Bucket bucket;
+            if (level == 0) {
+                bucket.firstNs = times[first];
+                bucket.lastNs = times[last - 1];
+                bucket.minNs = bucket.maxNs = times[first];
+                bucket.minValue = bucket.maxValue = values[first];
+                for (size_t i = first + 1; i < last; ++i) {
+                    if (values[i] < bucket.minValue) {
+                        bucket.minValue = values[i];
+                        bucket.minNs = times[i];
+                    }
+                    if (values[i] > bucket.maxValue) {
+                        bucket.maxValue = values[i];
+                        bucket.maxNs = times[i];
+                    }
+                }
+            } else {
+                const std::vector<Bucket> &lower = levels[level - 1];
+                bucket = lower[first];
+                for (size_t i = first + 1; i < last; ++i) {
+                    if (lower[i].minValue < bucket.minValue) {
+                        bucket.minValue = lower[i].minValue;
+                        bucket.minNs = lower[i].minNs;
+                    }
+                    if (lower[i].maxValue > bucket.maxValue) {
+                        bucket.maxValue = lower[i].maxValue;
+                        bucket.maxNs = lower[i].maxNs;
+                    }
+                }
+                bucket.lastNs = lower[last - 1].lastNs;
+            }
+            buckets[b] = bucket;
+        }
+        start /= kFanout;
+    }
+}
+
+void SignalPyramid::query(uint64_t fromNs, uint64_t toNs, size_t maxBuckets, std::vector<Point> &points) const
+{
+    points.clear();
+    if (times.empty() || toNs < fromNs) {
+        return;
+    }
+    maxBuckets = std::max<size_t>(1, maxBuckets);
+
+    // Few enough samples in range: draw them all
+    size_t low = std::lower_bound(times.begin(), times.end(), fromNs) - times.begin();
+    size_t high = std::upper_bound(times.begin(), times.end(), toNs) - times.begin();
+    if (high - low <= 2 * maxBuckets || levels.empty()) {
+        size_t first = low > 0 ? low - 1 : 0;
+        size_t last = std::min(high + 1, times.size());
+        points.reserve(last - first);
+        for (size_t i = first; i < last; ++i) {
+            points.push_back({times[i], values[i]});
+        }
+        return;
+    }
+
+    // Otherwise the finest level with at most maxBuckets buckets in range
+    for (size_t level = 0; level < levels.size(); ++level) {
+        const std::vector<Bucket> &buckets = levels[level];
+        size_t first = std::partition_point(buckets.begin(), buckets.end(),
+                                            [fromNs](const Bucket &b) { return b.lastNs < fromNs; }) - buckets.begin();
+        size_t last = std::partition_point(buckets.begin(), buckets.end(),
+                                           [toNs](const Bucket &b) { return b.firstNs <= toNs; }) - buckets.begin();
+        if (last - first > maxBuckets && level + 1 < levels.size()) {
+            continue;
+        }
+
+        first = first > 0 ? first - 1 : 0;
+        last = std::min(last + 1, buckets.size());
+        points.reserve(2 * (last - first));
+        for (size_t b = first; b < last; ++b) {
+            const Bucket &bucket = buckets[b];
+            if (bucket.minNs == bucket.maxNs && bucket.minValue == bucket.maxValue) {
+                points.push_back({bucket.minNs, bucket.minValue});
+            } else if (bucket.minNs <= bucket.maxNs) {
+                points.push_back({bucket.minNs, bucket.minValue});
+                points.push_back({bucket.maxNs, bucket.maxValue});
+            } else {
+                points.push_back({bucket.maxNs, bucket.maxValue});
+                points.push_back({bucket.minNs, bucket.minValue});
+            }
+        }
+        return;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef SIGNAL_PYRAMID_H
+#define SIGNAL_PYRAMID_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Multi-resolution min/max summary of one time series, for plotting. Level 0
+// groups kFanout samples per bucket, every further level groups kFanout
+// buckets of the level below, so any time range can be drawn from the
+// coarsest level that still has about one bucket per pixel. Each bucket
+// keeps its minimum and maximum samples, which keeps spikes visible at
+// every zoom level.
+class SignalPyramid
+{
+public:
+    static constexpr size_t kFanout = 8;
+
+    struct Point {
+        uint64_t timeNs = 0;
+        double value = 0.0;
+    };
+
+    void clear();
+
+    // Adds samples; timestamps should not go backwards. Samples older than
+    // the last one are merged in by rebuilding the pyramid.
+    void append(const uint64_t *timesNs, const double *values, size_t count);
+
+    size_t size() const { return times.size(); }
+    bool empty() const { return times.empty(); }
+    uint64_t firstTimestamp() const { return times.empty() ? 0 : times.front(); }
+    uint64_t lastTimestamp() const { return times.empty() ? 0 : times.back(); }
+    size_t levelCount() const { return levels.size(); }
+
+    // Samples describing [fromNs, toNs] with at most about 2 * maxBuckets
+    // points, plus the neighbours just outside so lines reach the edges.
+    // Buckets contribute their min and max samples in time order.
+    void query(uint64_t fromNs, uint64_t toNs, size_t maxBuckets, std::vector<Point> &points) const;
+
+private:
+    struct Bucket {
+        uint64_t firstNs = 0;
+        uint64_t lastNs = 0;
+        uint64_t minNs = 0;
+        uint64_t maxNs = 0;
+        double minValue = 0.0;
+        double maxValue = 0.0;
+    };
+
+    void rebuildLevels(size_t firstSample);
+
+    std::vector<uint64_t> times;
+    std::vector<double> values;
+    std::vector<std::vector<Bucket>> levels;  // levels[0] summarises the samples
+};
+
+#endif // SIGNAL_PYRAMID_H
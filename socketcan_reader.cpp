@@ -0,0 +1,232 @@
+#include "socketcan_reader.h"
+#include "can_log_parser.h"
+
+#ifdef __linux__
+#include <linux/can.h>
+#include <linux/can/error.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#endif
+
+SocketCANReader::~SocketCANReader()
+{
+    close();
+}
+
+#ifdef __linux__
+
+namespace {
+// Longest a stop request can go unnoticed while the bus is silent
+constexpr int kPollTimeoutMs = 100;
+
+// Kernel receive buffer asked for per socket, to ride out short stalls of
+// the reader thread on a busy bus
+constexpr int kReceiveBufferBytes = 4 * 1024 * 1024;
+
+LiveFrame toLiveFrame(const canfd_frame &raw, size_t bytes)
+{
+    LiveFrame frame;
+    canid_t canId = raw.can_id;
+    if (canId & CAN_ERR_FLAG) {
+        frame.flags = FrameError | FrameExtended;
+        frame.id = canId & CAN_EFF_MASK;
+    } else if (canId & CAN_EFF_FLAG) {
+        frame.flags = FrameExtended;
+        frame.id = canId & CAN_EFF_MASK;
+    } else {
+        frame.id = canId & CAN_SFF_MASK;
+    }
+
+    if (bytes == CANFD_MTU) {
+        frame.flags |= FrameFD;
+        if (raw.flags & CANFD_BRS) frame.flags |= FrameBRS;
+        if (raw.flags & CANFD_ESI) frame.flags |= FrameESI;
+        frame.dlc = std::min<uint8_t>(raw.len, CANFD_MAX_DLEN);
+    } else if (canId & CAN_RTR_FLAG) {
+        frame.flags |= FrameRemote;
+        frame.dlc = std::min<uint8_t>(raw.len, CAN_MAX_DLEN);
+        return frame;
+    } else {
+        frame.dlc = std::min<uint8_t>(raw.len, CAN_MAX_DLEN);
+    }
+    std::memcpy(frame.data, raw.data, frame.dlc);
+    return frame;
+}
+
+uint64_t wallClockNs()
+{
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+}
+
+bool SocketCANReader::open(const std::vector<std::string> &interfaceNames)
+{
+    close();
+    if (interfaceNames.empty() || interfaceNames.size() > UINT8_MAX) {
+        error = QString("Between 1 and %1 interfaces can be captured at once").arg(UINT8_MAX);
+        return false;
+    }
+
+    for (const std::string &name : interfaceNames) {
+        unsigned int ifindex = if_nametoindex(name.c_str());
+        if (ifindex == 0) {
+            error = QString("There is no CAN interface called %1").arg(QString::fromStdString(name));
+            close();
+            return false;
+        }
+
+        int fd = socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+        if (fd < 0) {
+            error = QString("Cannot open a CAN socket: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+            close();
+            return false;
+        }
+        sockets.push_back(fd);
+
+        // FD frames, error frames, kernel timestamps and drop counts are all
+        // optional: a kernel without them still delivers classic frames
+        int enable = 1;
+        can_err_mask_t errorMask = CAN_ERR_MASK;
+        int receiveBuffer = kReceiveBufferBytes;
+        setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable));
+        setsockopt(fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &errorMask, sizeof(errorMask));
+        setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+        setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+        sockaddr_can address = {};
+        address.can_family = AF_CAN;
+        address.can_ifindex = static_cast<int>(ifindex);
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+            error = QString("Cannot bind to %1: %2").arg(QString::fromStdString(name),
+                                                       QString::fromLocal8Bit(std::strerror(errno)));
+            close();
+            return false;
+        }
+        names.push_back(name);
+    }
+    kernelDropCounts.assign(sockets.size(), 0);
+    error.clear();
+    return true;
+}
+
+void SocketCANReader::run(LiveFeed &feed, const std::atomic<bool> &stop)
+{
+    std::vector<pollfd> polled(sockets.size());
+    for (size_t i = 0; i < sockets.size(); ++i) {
+        polled[i].fd = sockets[i];
+        polled[i].events = POLLIN;
+    }
+
+    // One receive slot per batched frame: the frame, its iovec and room for
+    // the timestamp and drop count control messages
+    constexpr size_t kControlBytes = CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t));
+    std::vector<canfd_frame> frames(kBatchFrames);
+    std::vector<iovec> vectors(kBatchFrames);
+    std::vector<mmsghdr> messages(kBatchFrames);
+    std::vector<char> control(kBatchFrames * kControlBytes);
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        int ready = poll(polled.data(), polled.size(), kPollTimeoutMs);
+        if (ready <= 0) {
+            continue;
+        }
+
+        for (size_t s = 0; s < polled.size(); ++s) {
+            if (polled[s].revents == 0) {
+                continue;
+            }
+
+            // Empty the socket, a full batch at a time
+            int received;
+            do {
+                for (size_t i = 0; i < kBatchFrames; ++i) {
+                    vectors[i].iov_base = &frames[i];
+                    vectors[i].iov_len = sizeof(canfd_frame);
+                    std::memset(&messages[i].msg_hdr, 0, sizeof(msghdr));
+                    messages[i].msg_hdr.msg_iov = &vectors[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                    messages[i].msg_hdr.msg_control = control.data() + i * kControlBytes;
+                    messages[i].msg_hdr.msg_controllen = kControlBytes;
+                }
+                // A socket error (e.g. the interface went down) is returned
+                // once here and cleared, the next poll waits for frames again
+                received = recvmmsg(sockets[s], messages.data(), kBatchFrames, MSG_DONTWAIT, nullptr);
+                if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    feed.addReadError();
+                }
+
+                for (int i = 0; i < received; ++i) {
+                    size_t bytes = messages[i].msg_len;
+                    if (bytes != CAN_MTU && bytes != CANFD_MTU) {
+                        continue;
+                    }
+                    LiveFrame frame = toLiveFrame(frames[i], bytes);
+                    frame.interface = static_cast<uint8_t>(s);
+
+                    frame.timestampNs = 0;
+                    msghdr &header = messages[i].msg_hdr;
+                    for (cmsghdr *message = CMSG_FIRSTHDR(&header); message; message = CMSG_NXTHDR(&header, message)) {
+                        if (message->cmsg_level != SOL_SOCKET) {
+                            continue;
+                        }
+                        if (message->cmsg_type == SO_TIMESTAMPNS) {
+                            timespec stamp;
+                            std::memcpy(&stamp, CMSG_DATA(message), sizeof(stamp));
+                            frame.timestampNs = static_cast<uint64_t>(stamp.tv_sec) * 1000000000ull
+                                              + static_cast<uint64_t>(stamp.tv_nsec);
+                        } else if (message->cmsg_type == SO_RXQ_OVFL) {
+                            // A running total per socket
+                            uint32_t dropped;
+                            std::memcpy(&dropped, CMSG_DATA(message), sizeof(dropped));
+                            feed.addKernelDrops(dropped - kernelDropCounts[s]);
+                            kernelDropCounts[s] = dropped;
+                        }
+                    }
+                    if (frame.timestampNs == 0) {
+                        frame.timestampNs = wallClockNs();
+                    }
+                    feed.push(frame);
+                }
+            } while (received == static_cast<int>(kBatchFrames) && !stop.load(std::memory_order_relaxed));
+        }
+    }
+}
+
+void SocketCANReader::close()
+{
+    for (int fd : sockets) {
+        ::close(fd);
+    }
+    sockets.clear();
+    names.clear();
+    kernelDropCounts.clear();
+}
+
+#else
+
+bool SocketCANReader::open(const std::vector<std::string> &)
+{
+    error = QString("Live capture needs Linux SocketCAN");
+    return false;
+}
+
+void SocketCANReader::run(LiveFeed &, const std::atomic<bool> &)
+{
+}
+
+void SocketCANReader::close()
+{
+}
+
+#endif
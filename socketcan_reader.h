@@ -0,0 +1,46 @@
+#ifndef SOCKETCAN_READER_H
+#define SOCKETCAN_READER_H
+#pragma once
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "live_capture.h"
+
+// Reads raw SocketCAN interfaces (can0, vcan0, ...) on Linux. Each interface
+// gets its own CAN_RAW socket with FD frames and error frames enabled; the
+// reader thread polls them all and takes up to kBatchFrames frames per
+// recvmmsg() call. Frames are stamped by the kernel on arrival
+// (SO_TIMESTAMPNS), and frames the socket queue dropped are counted through
+// SO_RXQ_OVFL. Elsewhere open() fails with an explanation.
+class SocketCANReader : public LiveReader
+{
+public:
+    static constexpr size_t kBatchFrames = 64;
+
+    SocketCANReader() = default;
+    ~SocketCANReader() override;
+
+    SocketCANReader(const SocketCANReader &) = delete;
+    SocketCANReader &operator=(const SocketCANReader &) = delete;
+
+    // Opens and binds one socket per interface name. Returns false with
+    // errorString() set if any of them cannot be opened.
+    bool open(const std::vector<std::string> &interfaceNames);
+    QString errorString() const { return error; }
+
+    const std::vector<std::string> &interfaces() const override { return names; }
+    void run(LiveFeed &feed, const std::atomic<bool> &stop) override;
+
+private:
+    void close();
+
+    std::vector<int> sockets;
+    std::vector<std::string> names;
+    std::vector<uint32_t> kernelDropCounts;  // last SO_RXQ_OVFL value per socket
+    QString error;
+};
+
+#endif // SOCKETCAN_READER_H
@@ -0,0 +1,82 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue between exactly one producer thread and one consumer
+// thread. Each side owns one index and only reads the other's, refreshing its
+// cached copy when the ring looks full or empty, so the two sides rarely touch
+// each other's cache line. Pushing never blocks; a full ring refuses the item.
+template <typename T>
+class SpscRing
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity)
+    {
+        size_t slotCount = 2;
+        while (slotCount < capacity) {
+            slotCount *= 2;
+        }
+        slots.resize(slotCount);
+        mask = slotCount - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    size_t capacity() const { return slots.size(); }
+
+    // Producer side. Returns false, leaving the ring untouched, when it is full
+    bool push(const T &item)
+    {
+        size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - cachedReadIndex == slots.size()) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            if (head - cachedReadIndex == slots.size()) {
+                return false;
+            }
+        }
+        slots[head & mask] = item;
+        writeIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Moves up to maxItems items into out and returns how many
+    size_t pop(T *out, size_t maxItems)
+    {
+        size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (cachedWriteIndex == tail) {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+        }
+        size_t count = std::min(cachedWriteIndex - tail, maxItems);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = slots[(tail + i) & mask];
+        }
+        readIndex.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Approximate from either side, exact when the other side is idle
+    size_t size() const
+    {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    std::vector<T> slots;
+    size_t mask = 0;
+
+    alignas(kCacheLine) std::atomic<size_t> writeIndex{0};  // next slot to fill, written by the producer
+    size_t cachedReadIndex = 0;                             // producer's view of readIndex
+    alignas(kCacheLine) std::atomic<size_t> readIndex{0};   // next slot to drain, written by the consumer
+    size_t cachedWriteIndex = 0;                            // consumer's view of writeIndex
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,61 @@
+#include "time_index.h"
+
+#include <algorithm>
+
+void TimeIndex::clear()
+{
+    blockPrefixMax.clear();
+    indexedRows = 0;
+    minTimestamp = UINT64_MAX;
+    maxTimestamp = 0;
+    sorted = true;
+}
+
+void TimeIndex::update(const CANFrameStore &store)
+{
+    const FrameColumn<uint64_t> &timestamps = store.timestamps();
+    if (timestamps.size() <= indexedRows) {
+        return;
+    }
+
+    // The last block may have been partial, it is recomputed from its start
+    uint64_t runningMax = maxTimestamp;
+    uint64_t previous = indexedRows > 0 ? timestamps[indexedRows - 1] : 0;
+    if (indexedRows % kBlockRows != 0) {
+        blockPrefixMax.pop_back();
+    }
+
+    for (size_t row = indexedRows; row < timestamps.size(); ++row) {
+        uint64_t timestamp = timestamps[row];
+        sorted = sorted && timestamp >= previous;
+        previous = timestamp;
+        runningMax = std::max(runningMax, timestamp);
+        minTimestamp = std::min(minTimestamp, timestamp);
+        if ((row + 1) % kBlockRows == 0) {
+            blockPrefixMax.push_back(runningMax);
+        }
+    }
+    if (timestamps.size() % kBlockRows != 0) {
+        blockPrefixMax.push_back(runningMax);
+    }
+
+    maxTimestamp = runningMax;
+    indexedRows = timestamps.size();
+}
+
+size_t TimeIndex::findRow(const CANFrameStore &store, uint64_t timestampNs) const
+{
+    auto block = std::lower_bound(blockPrefixMax.begin(), blockPrefixMax.end(), timestampNs);
+    if (block == blockPrefixMax.end()) {
+        return indexedRows;
+    }
+
+    // Every row before this block is earlier than timestampNs, and the block
+    // holds at least one row that is not
+    const FrameColumn<uint64_t> &timestamps = store.timestamps();
+    auto first = timestamps.begin() + static_cast<std::ptrdiff_t>((block - blockPrefixMax.begin()) * kBlockRows);
+    auto last = timestamps.begin() + static_cast<std::ptrdiff_t>(std::min(indexedRows, static_cast<size_t>(first - timestamps.begin()) + kBlockRows));
+    auto found = sorted ? std::lower_bound(first, last, timestampNs)
+                        : std::find_if(first, last, [timestampNs](uint64_t t) { return t >= timestampNs; });
+    return static_cast<size_t>(found - timestamps.begin());
+}
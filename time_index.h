@@ -0,0 +1,40 @@
+#ifndef TIME_INDEX_H
+#define TIME_INDEX_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "frame_store.h"
+
+// Sparse timestamp index over a CANFrameStore. Keeps the running maximum
+// timestamp at the end of every block of kBlockRows frames, which is monotone
+// even when the log itself is not, so finding the first frame at or after a
+// given time is a binary search plus a scan of one block.
+class TimeIndex
+{
+public:
+    static constexpr size_t kBlockRows = 4096;
+
+    void clear();
+
+    // Indexes the frames appended to store since the last call
+    void update(const CANFrameStore &store);
+
+    // First row (in store order) whose timestamp is >= timestampNs, or
+    // store.size() when there is none
+    size_t findRow(const CANFrameStore &store, uint64_t timestampNs) const;
+
+    bool empty() const { return indexedRows == 0; }
+    uint64_t firstTimestamp() const { return minTimestamp; }
+    uint64_t lastTimestamp() const { return maxTimestamp; }
+
+private:
+    std::vector<uint64_t> blockPrefixMax;  // max timestamp over rows [0, (b + 1) * kBlockRows)
+    size_t indexedRows = 0;
+    uint64_t minTimestamp = UINT64_MAX;
+    uint64_t maxTimestamp = 0;
+    bool sorted = true;                    // lets findRow binary search the column directly
+};
+
+#endif // TIME_INDEX_H